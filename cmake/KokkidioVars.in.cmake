@@ -6,4 +6,5 @@ set(Kokkos_DEVICES "@Kokkos_DEVICES@")
 set(Kokkos_DEVICES "@Kokkos_DEVICES@")
 @OMP_RPATH_LINE@
 set(KOKKIDIO_NO_ARCH_NATIVE_CMAKE "@KOKKIDIO_NO_ARCH_NATIVE_CMAKE@")
+set(KOKKIDIO_HOST_THREADPOOL_CMAKE "@KOKKIDIO_HOST_THREADPOOL_CMAKE@")
 
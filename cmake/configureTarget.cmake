@@ -44,6 +44,18 @@ macro(kokkidio_configure_target TARGET_NAME)
 		message(WARNING "Could not find OpenMP.")
 	endif()
 
+	# host kernels run on Kokkidio's own thread pool instead of OpenMP
+	if(KOKKIDIO_HOST_THREADPOOL_CMAKE)
+		message(STATUS "${TARGET_NAME}: using the Kokkidio thread pool for host kernels.")
+		find_package(Threads REQUIRED)
+		target_link_libraries( ${TARGET_NAME} ${TARGET_VISIBILITY}
+			Threads::Threads
+		)
+		target_compile_definitions( ${TARGET_NAME} ${TARGET_VISIBILITY}
+			KOKKIDIO_HOST_THREADPOOL
+		)
+	endif()
+
 	target_compile_definitions( ${TARGET_NAME} ${TARGET_VISIBILITY}
 		${KOKKIDIO_BACKEND}
 		${KOKKIDIO_KOKKOS_BACKEND}
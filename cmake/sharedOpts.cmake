@@ -34,3 +34,13 @@ if(NOT DEFINED KOKKIDIO_NO_ARCH_NATIVE_CMAKE)
 	message(STATUS "Set \"KOKKIDIO_NO_ARCH_NATIVE\" to ON to disable.")
 	set(KOKKIDIO_NO_ARCH_NATIVE_CMAKE OFF)
 endif()
+
+
+set_if_defined(KOKKIDIO_HOST_THREADPOOL_CMAKE KOKKIDIO_HOST_THREADPOOL)
+if(NOT DEFINED KOKKIDIO_HOST_THREADPOOL_CMAKE)
+	message(STATUS "Using OpenMP for parallel host kernels.")
+	message(STATUS "Set \"KOKKIDIO_HOST_THREADPOOL\" to ON "
+		"to use the Kokkidio work-stealing thread pool instead."
+	)
+	set(KOKKIDIO_HOST_THREADPOOL_CMAKE OFF)
+endif()
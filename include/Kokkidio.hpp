@@ -9,10 +9,18 @@
 #include "Kokkidio/mathWrapper.hpp"
 #include "Kokkidio/ViewMap.hpp"
 #include "Kokkidio/DualViewMap.hpp"
+#include "Kokkidio/DualViewMapGroup.hpp"
+#include "Kokkidio/FixedViewMap.hpp"
+#include "Kokkidio/MappedFile.hpp"
+#include "Kokkidio/Checkpoint.hpp"
 #include "Kokkidio/ParallelRange.hpp"
 #include "Kokkidio/AccessBuffer.hpp"
 #include "Kokkidio/parallel_for.hpp"
+#include "Kokkidio/ParallelRange2D.hpp"
 #include "Kokkidio/parallel_reduce.hpp"
+#include "Kokkidio/parallel_tiles.hpp"
+#include "Kokkidio/parallel_team.hpp"
+#include "Kokkidio/ExecutionContext.hpp"
 
 #undef KOKKIDIO_PUBLIC_HEADER
 
@@ -0,0 +1,278 @@
+#ifndef KOKKIDIO_CACHINGALLOCATOR_HPP
+#define KOKKIDIO_CACHINGALLOCATOR_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/TargetSpaces.hpp"
+#include "Kokkidio/macros.hpp"
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Opt-in, size-bucketed cache of allocations in @a MemorySpace.
+ * There is one instance per memory space, accessed via get()
+ * or the factory function cachingAllocator<target>().
+ *
+ * When enabled, ViewMap (and therefore DualViewMap) draw their memory
+ * from this cache instead of allocating a new Kokkos::View.
+ * Blocks are themselves managed Kokkos::Views,
+ * so that any copy of a ViewMap (including those captured by a KOKKOS_LAMBDA)
+ * keeps its block alive. Once only the cache holds a reference to a block,
+ * it is reused for the next request of the same bucket size.
+ * Because asynchronous copies and kernels may still use it,
+ * the default instance of the memory space's execution space is fenced first,
+ * as well as the instance recorded by recordUse(), if any.
+ * Other instances are not fenced.
+ * Bucket sizes are powers of two, starting at minBlockBytes.
+ *
+ * Note that with caching enabled, ViewMap::view() returns an unmanaged View,
+ * which must not outlive the ViewMap it was obtained from.
+ *
+ * @tparam _MemorySpace
+ * @tparam _hostMemory keeps blocks with different HostMemoryPolicy apart,
+ * e.g. pageable and hugepages, which share the same memory space.
+ */
+template<
+	typename _MemorySpace,
+	HostMemoryPolicy _hostMemory = HostMemoryPolicy::pageable
+>
+class CachingAllocator {
+public:
+	using MemorySpace = _MemorySpace;
+	static constexpr HostMemoryPolicy hostMemory {_hostMemory};
+	using BlockType = Kokkos::View<std::byte*, MemorySpace>;
+
+	static constexpr std::size_t minBlockBytes {256};
+
+	struct Stats {
+		std::size_t
+			hits   {0},
+			misses {0},
+			/* number of blocks and their total size held by the cache,
+			 * including those currently in use */
+			blocks {0},
+			bytes  {0};
+	};
+
+protected:
+	bool m_enabled {false};
+	bool m_finalizeHookSet {false};
+	std::map<std::size_t, std::vector<BlockType>> m_buckets;
+	/* Fences the instance which last used a cached block,
+	 * keyed by the block's address, see recordUse() */
+	std::map<const std::byte*, std::function<void()>> m_lastUse;
+	Stats m_stats;
+	mutable std::mutex m_mutex;
+
+	CachingAllocator() = default;
+
+public:
+	CachingAllocator(const CachingAllocator&) = delete;
+	CachingAllocator& operator=(const CachingAllocator&) = delete;
+
+	static CachingAllocator& get(){
+		static CachingAllocator instance;
+		return instance;
+	}
+
+	static std::size_t bucketSize(std::size_t bytes){
+		std::size_t bucket {minBlockBytes};
+		while (bucket < bytes){
+			bucket *= 2;
+		}
+		return bucket;
+	}
+
+	void enable(bool arg = true){
+		std::lock_guard<std::mutex> lock {m_mutex};
+		m_enabled = arg;
+		/* Cached blocks must be released before Kokkos is finalised */
+		if ( m_enabled && !m_finalizeHookSet ){
+			Kokkos::push_finalize_hook( [](){
+				CachingAllocator::get().clear();
+			} );
+			m_finalizeHookSet = true;
+		}
+	}
+
+	void disable(){
+		this->enable(false);
+	}
+
+	bool isEnabled() const {
+		std::lock_guard<std::mutex> lock {m_mutex};
+		return m_enabled;
+	}
+
+	/**
+	 * @brief Returns a block of at least @a bytes bytes.
+	 * Reuses a cached block of the same bucket size if one is free (hit),
+	 * which fences the instances which may still use it first,
+	 * and allocates a new one otherwise (miss).
+	 */
+	BlockType allocate(std::size_t bytes){
+		std::size_t size { bucketSize(bytes) };
+		BlockType reused;
+		std::function<void()> fenceLastUse;
+		{
+			std::lock_guard<std::mutex> lock {m_mutex};
+			auto& bucket { m_buckets[size] };
+			for ( const BlockType& block : bucket ){
+				if ( block.use_count() == 1 ){
+					++m_stats.hits;
+					printd( "CachingAllocator: reusing block (%p), %lu bytes.\n"
+						, (void*) block.data(), size
+					);
+					/* the copy marks the block as in use */
+					reused = block;
+					if ( auto it { m_lastUse.find( block.data() ) };
+						it != m_lastUse.end()
+					){
+						fenceLastUse = std::move(it->second);
+						m_lastUse.erase(it);
+					}
+					break;
+				}
+			}
+		}
+		if ( reused.data() ){
+			/* Copies and kernels on a block may still be in flight
+			 * after its last ViewMap was destroyed.
+			 * Done outside the lock, so that other threads aren't held up. */
+			typename MemorySpace::execution_space{}.fence(
+				"Kokkidio::CachingAllocator::allocate"
+			);
+			if (fenceLastUse){
+				fenceLastUse();
+			}
+			return reused;
+		}
+		return this->allocateNew(size);
+	}
+
+	/**
+	 * @brief Records that work on @a block was enqueued on the
+	 * execution space instance @a space, e.g. by a DualViewMap copy
+	 * which returned a TransferHandle.
+	 * That instance is then fenced before the block is reused.
+	 * Only the last recorded instance is kept per block.
+	 * Blocks which were not drawn from this cache are ignored.
+	 */
+	template<typename ExecutionSpace>
+	void recordUse(const BlockType& block, const ExecutionSpace& space){
+		std::lock_guard<std::mutex> lock {m_mutex};
+		auto bucket { m_buckets.find( block.extent(0) ) };
+		if ( bucket == m_buckets.end() || std::none_of(
+			bucket->second.begin(), bucket->second.end(),
+			[&](const BlockType& cached){ return cached.data() == block.data(); }
+		) ){
+			return;
+		}
+		m_lastUse[ block.data() ] = [space](){
+			space.fence("Kokkidio::CachingAllocator::allocate");
+		};
+	}
+
+protected:
+	BlockType allocateNew(std::size_t size){
+		std::lock_guard<std::mutex> lock {m_mutex};
+		auto& bucket { m_buckets[size] };
+		++m_stats.misses;
+		++m_stats.blocks;
+		m_stats.bytes += size;
+		bucket.emplace_back(
+			Kokkos::view_alloc(
+				MemorySpace{}, Kokkos::WithoutInitializing,
+				"Kokkidio::CachingAllocator::block"
+			),
+			size
+		);
+		printd( "CachingAllocator: allocated block (%p), %lu bytes.\n"
+			, (void*) bucket.back().data(), size
+		);
+		return bucket.back();
+	}
+
+public:
+	/**
+	 * @brief Releases all cached blocks which are currently not in use.
+	 * @return The number of bytes released.
+	 */
+	std::size_t trim(){
+		std::lock_guard<std::mutex> lock {m_mutex};
+		std::size_t released {0};
+		for ( auto& [size, bucket] : m_buckets ){
+			std::size_t nBefore { bucket.size() };
+			bucket.erase(
+				std::remove_if( bucket.begin(), bucket.end(),
+					[&](const BlockType& block){
+						if ( block.use_count() == 1 ){
+							m_lastUse.erase( block.data() );
+							return true;
+						}
+						return false;
+					}
+				),
+				bucket.end()
+			);
+			std::size_t nReleased { nBefore - bucket.size() };
+			released += nReleased * size;
+			m_stats.blocks -= nReleased;
+		}
+		m_stats.bytes -= released;
+		return released;
+	}
+
+	Stats stats() const {
+		std::lock_guard<std::mutex> lock {m_mutex};
+		return m_stats;
+	}
+
+	void resetStats(){
+		std::lock_guard<std::mutex> lock {m_mutex};
+		m_stats.hits   = 0;
+		m_stats.misses = 0;
+	}
+
+protected:
+	/* Drops all references held by the cache.
+	 * Blocks still in use are freed along with their last ViewMap. */
+	void clear(){
+		std::lock_guard<std::mutex> lock {m_mutex};
+		m_buckets.clear();
+		m_lastUse.clear();
+		m_stats = {};
+	}
+};
+
+/**
+ * @brief Returns the CachingAllocator used by
+ * ViewMap<EigenType, targetArg, hostMemory>.
+ */
+template<
+	Target targetArg = DefaultTarget,
+	HostMemoryPolicy hostMemory = HostMemoryPolicy::pageable
+>
+auto& cachingAllocator(){
+	constexpr Target target { ExecutionTarget<targetArg> };
+	constexpr HostMemoryPolicy policy {
+		detail::hostMemoryPolicy<target, hostMemory>
+	};
+	return CachingAllocator<MemorySpace<target, policy>, policy>::get();
+}
+
+} // namespace Kokkidio
+
+#endif
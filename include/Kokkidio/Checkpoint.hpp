@@ -0,0 +1,661 @@
+#ifndef KOKKIDIO_CHECKPOINT_HPP
+#define KOKKIDIO_CHECKPOINT_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/ViewMap.hpp"
+#include "Kokkidio/DualViewMap.hpp"
+#include "Kokkidio/scalarTag.hpp"
+
+#include <Kokkos_Core.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace Kokkidio
+{
+
+namespace detail::checkpoint
+{
+
+/* A checkpoint file consists of this header,
+ * followed by one record per object, each consisting of a RecordHeader
+ * and the raw data in the byte order of the machine which wrote it.
+ * The data is stored without padding, in the storage order
+ * of the (host-side) Eigen type. */
+struct FileHeader {
+	static constexpr char magicValue[8] {'K','K','D','C','K','P','N','T'};
+	static constexpr std::uint32_t versionValue {1};
+
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t reserved0;
+	std::uint64_t records;
+	unsigned char reserved[40];
+};
+static_assert( sizeof(FileHeader) == 64 );
+static_assert( std::is_trivially_copyable_v<FileHeader> );
+
+struct RecordHeader {
+	ScalarTag scalar;
+	std::uint32_t rowMajor;
+	std::int64_t rows;
+	std::int64_t cols;
+	unsigned char reserved[40];
+};
+static_assert( sizeof(RecordHeader) == 64 );
+static_assert( std::is_trivially_copyable_v<RecordHeader> );
+
+class File {
+protected:
+	std::string m_path;
+	std::FILE* m_file {nullptr};
+
+public:
+	File( const std::string& path, const char* mode ) :
+		m_path {path},
+		m_file { std::fopen( path.c_str(), mode ) }
+	{
+		if ( !this->m_file ){
+			this->fail("open failed");
+		}
+	}
+
+	File(const File&) = delete;
+	File& operator=(const File&) = delete;
+
+	File(File&& other) noexcept :
+		m_path { std::move(other.m_path) },
+		m_file { std::exchange(other.m_file, nullptr) }
+	{}
+
+	File& operator=(File&& other) noexcept {
+		if (this != &other){
+			if (this->m_file){
+				std::fclose(this->m_file);
+			}
+			this->m_path = std::move(other.m_path);
+			this->m_file = std::exchange(other.m_file, nullptr);
+		}
+		return *this;
+	}
+
+	~File(){
+		if (this->m_file){
+			std::fclose(this->m_file);
+		}
+	}
+
+	auto path() const -> const std::string& {
+		return this->m_path;
+	}
+
+	[[noreturn]] void fail(const std::string& what) const {
+		throw std::system_error(
+			errno, std::generic_category(),
+			"Checkpoint (" + this->m_path + "): " + what
+		);
+	}
+
+	[[noreturn]] void invalid(const std::string& what) const {
+		throw std::runtime_error(
+			"Checkpoint (" + this->m_path + "): " + what
+		);
+	}
+
+	void write( const void* data, std::size_t bytes ){
+		if ( bytes > 0 && std::fwrite(data, 1, bytes, this->m_file) != bytes ){
+			this->fail("write failed");
+		}
+	}
+
+	void read( void* data, std::size_t bytes ){
+		if ( bytes > 0 && std::fread(data, 1, bytes, this->m_file) != bytes ){
+			if ( std::feof(this->m_file) ){
+				this->invalid("unexpected end of file.");
+			}
+			this->fail("read failed");
+		}
+	}
+
+	void seek( long offset, int origin ){
+		if ( std::fseek(this->m_file, offset, origin) != 0 ){
+			this->fail("seek failed");
+		}
+	}
+
+	void flush(){
+		if ( std::fflush(this->m_file) != 0 ){
+			this->fail("flush failed");
+		}
+	}
+};
+
+/* Default size of the chunks in which data is streamed
+ * between the target and the file */
+inline constexpr std::size_t defaultChunkBytes { std::size_t{16} << 20 };
+
+/* Unmanaged View over @a nOuter contiguous columns
+ * (or rows, if @a Layout is LayoutRight) of @a nInner elements */
+template<typename Layout, typename MemSpace, typename S>
+auto chunkView( S* data, Index nInner, Index nOuter ){
+	using V = Kokkos::View<S**, Layout, MemSpace,
+		Kokkos::MemoryTraits<Kokkos::Unmanaged>
+	>;
+	const auto inner { static_cast<std::size_t>(nInner) };
+	const auto outer { static_cast<std::size_t>(nOuter) };
+	if constexpr ( std::is_same_v<Layout, Kokkos::LayoutRight> ){
+		return V( data, outer, inner );
+	} else {
+		return V( data, inner, outer );
+	}
+}
+
+template<bool rowMajor, typename View>
+auto outerSubview( const View& view, Index start, Index size ){
+	auto pair { Kokkos::make_pair(
+		static_cast<std::size_t>(start),
+		static_cast<std::size_t>(start + size)
+	) };
+	if constexpr (rowMajor){
+		return Kokkos::subview(view, pair, Kokkos::ALL);
+	} else {
+		return Kokkos::subview(view, Kokkos::ALL, pair);
+	}
+}
+
+/**
+ * @brief The page-locked host buffers and execution space instances
+ * used by stream(), which a CheckpointWriter or CheckpointReader
+ * keeps for all of its records.
+ * The buffers grow to the largest chunk streamed so far.
+ */
+class StreamResources {
+public:
+	using BufSpace = Kokkidio::MemorySpace<Target::host, HostMemoryPolicy::pinned>;
+	using HostBuf  = Kokkos::View<std::byte*, BufSpace>;
+
+protected:
+	std::array<HostBuf, 2> m_hostBuf;
+	std::vector<std::byte> m_convertBuf;
+	std::vector<Kokkos::DefaultExecutionSpace> m_spaces;
+	std::vector<Kokkos::DefaultHostExecutionSpace> m_hostSpaces;
+
+	template<typename ExecSpace>
+	static void partition( std::vector<ExecSpace>& spaces ){
+		if ( spaces.empty() ){
+			spaces = Kokkos::Experimental::partition_space( ExecSpace{}, 1, 1 );
+		}
+	}
+
+public:
+	/* Page-locked buffer @a b, with room for @a n elements of type S */
+	template<typename S>
+	S* hostBuf( int b, std::size_t n ){
+		HostBuf& buf { this->m_hostBuf[b] };
+		if ( buf.size() < n * sizeof(S) ){
+			/* release the old buffer first */
+			buf = {};
+			buf = HostBuf{
+				Kokkos::view_alloc( Kokkos::WithoutInitializing,
+					"Kokkidio::Checkpoint::hostBuf"
+				),
+				n * sizeof(S)
+			};
+		}
+		return reinterpret_cast<S*>( buf.data() );
+	}
+
+	/* Buffer with room for @a n elements of type S,
+	 * for converting a chunk to the scalar type of the file */
+	template<typename S>
+	S* convertBuf( std::size_t n ){
+		if ( this->m_convertBuf.size() < n * sizeof(S) ){
+			this->m_convertBuf.resize( n * sizeof(S) );
+		}
+		return reinterpret_cast<S*>( this->m_convertBuf.data() );
+	}
+
+	/* Two instances of @a ExecSpace */
+	template<typename ExecSpace>
+	auto spaces() -> std::vector<ExecSpace> {
+		if constexpr ( std::is_same_v<ExecSpace, Kokkos::DefaultExecutionSpace> ){
+			partition(this->m_spaces);
+			return this->m_spaces;
+		} else
+		if constexpr ( std::is_same_v<ExecSpace, Kokkos::DefaultHostExecutionSpace> ){
+			partition(this->m_hostSpaces);
+			return this->m_hostSpaces;
+		} else {
+			return Kokkos::Experimental::partition_space( ExecSpace{}, 1, 1 );
+		}
+	}
+};
+
+/**
+ * @brief Streams the data of @a view between its memory space and @a file,
+ * in chunks of whole columns (or rows, if @a rowMajor is true).
+ *
+ * Host-accessible data which is already contiguous in file order
+ * is read or written in one piece.
+ * Otherwise, each chunk passes through one of two page-locked host buffers,
+ * and the chunks alternate between two execution space instances:
+ * while one chunk is written to (or read from) the file,
+ * the next one is already being copied.
+ * Data which is not contiguous in file order,
+ * e.g. for LayoutPolicy::soa or LayoutPolicy::padded,
+ * is additionally staged in a contiguous buffer in its own memory space.
+ *
+ * When writing, each chunk is converted to @a FileScalar on the host,
+ * if the View has a different scalar type.
+ */
+template<bool toFile, bool rowMajor, typename FileScalar, typename View>
+void stream(
+	File& file, StreamResources& res, const View& view, std::size_t chunkBytes
+){
+	using S         = typename View::non_const_value_type;
+	using MemSpace  = typename View::memory_space;
+	using ExecSpace = typename View::execution_space;
+	using Layout    = std::conditional_t<rowMajor,
+		Kokkos::LayoutRight, Kokkos::LayoutLeft
+	>;
+	using BufSpace = StreamResources::BufSpace;
+	constexpr bool hostAccessible {
+		Kokkos::SpaceAccessibility<Kokkos::HostSpace, MemSpace>::accessible
+	};
+	constexpr bool converts { !std::is_same_v<S, FileScalar> };
+	static_assert( toFile || !converts,
+		"Checkpoint: conversions are only supported when writing."
+	);
+	const Index
+		nInner { static_cast<Index>( view.extent(rowMajor ? 1 : 0) ) },
+		nOuter { static_cast<Index>( view.extent(rowMajor ? 0 : 1) ) };
+	const bool isContiguous {
+		std::is_same_v<typename View::array_layout, Layout> &&
+		view.span_is_contiguous()
+	};
+
+	if ( hostAccessible && isContiguous && !converts ){
+		printd( "Checkpoint: %s %i x %i elements directly.\n"
+			, toFile ? "writing" : "reading"
+			, static_cast<int>(nInner), static_cast<int>(nOuter)
+		);
+		ExecSpace{}.fence("Kokkidio::Checkpoint::stream");
+		const std::size_t bytes { view.size() * sizeof(S) };
+		if constexpr (toFile){
+			file.write( view.data(), bytes );
+		} else {
+			file.read( const_cast<S*>( view.data() ), bytes );
+		}
+		return;
+	}
+
+	if ( nInner == 0 || nOuter == 0 ){
+		return;
+	}
+	const Index chunkSize { std::clamp<Index>(
+		static_cast<Index>( chunkBytes / ( nInner * sizeof(S) ) ), 1, nOuter
+	) };
+	const Index nChunks { (nOuter + chunkSize - 1) / chunkSize };
+	printd( "Checkpoint: %s %i x %i elements in %i chunks%s.\n"
+		, toFile ? "writing" : "reading"
+		, static_cast<int>(nInner), static_cast<int>(nOuter)
+		, static_cast<int>(nChunks)
+		, isContiguous ? "" : ", staged"
+	);
+
+	using StageBuf = Kokkos::View<S*, MemSpace>;
+	const auto bufSize { static_cast<std::size_t>( nInner * chunkSize ) };
+	std::array<S*, 2> hostBuf;
+	std::array<StageBuf, 2> stageBuf;
+	for (int b {0}; b < std::min<int>(2, nChunks); ++b){
+		hostBuf[b] = res.template hostBuf<S>(b, bufSize);
+		if ( !isContiguous ){
+			stageBuf[b] = StageBuf{
+				Kokkos::view_alloc( Kokkos::WithoutInitializing,
+					"Kokkidio::Checkpoint::stageBuf"
+				),
+				bufSize
+			};
+		}
+	}
+
+	auto spaces { res.template spaces<ExecSpace>() };
+	auto chunkRange = [&](Index c){
+		const Index start { c * chunkSize };
+		return std::make_pair( start, std::min( chunkSize, nOuter - start ) );
+	};
+	/* source or destination of the copy from/to the host buffer */
+	auto deviceChunk = [&](int b, Index start, Index size){
+		return chunkView<Layout, MemSpace>( isContiguous ?
+			const_cast<S*>( view.data() ) + start * nInner :
+			stageBuf[b].data(),
+			nInner, size
+		);
+	};
+	auto hostChunk = [&](int b, Index size){
+		return chunkView<Layout, BufSpace>( hostBuf[b], nInner, size );
+	};
+	auto fileBytes = [&](Index size){
+		return static_cast<std::size_t>(nInner * size) * sizeof(FileScalar);
+	};
+
+	if constexpr (toFile){
+		/* Work on one instance is ordered, and each buffer is written
+		 * to the file before it is reused, two chunks later */
+		auto enqueue = [&](Index c){
+			const int b { static_cast<int>(c % 2) };
+			auto [start, size] { chunkRange(c) };
+			auto src { deviceChunk(b, start, size) };
+			if ( !isContiguous ){
+				Kokkos::deep_copy( spaces[b], src,
+					outerSubview<rowMajor>(view, start, size)
+				);
+			}
+			Kokkos::deep_copy( spaces[b], hostChunk(b, size), src );
+		};
+		enqueue(0);
+		for (Index c {0}; c < nChunks; ++c){
+			if (c + 1 < nChunks){
+				enqueue(c + 1);
+			}
+			const int b { static_cast<int>(c % 2) };
+			spaces[b].fence("Kokkidio::Checkpoint::write");
+			const Index size { chunkRange(c).second };
+			if constexpr (converts){
+				const std::size_t n { static_cast<std::size_t>(nInner * size) };
+				FileScalar* converted { res.template convertBuf<FileScalar>(n) };
+				std::transform( hostBuf[b], hostBuf[b] + n, converted,
+					[](S val){ return static_cast<FileScalar>(val); }
+				);
+				file.write( converted, fileBytes(size) );
+			} else {
+				file.write( hostBuf[b], fileBytes(size) );
+			}
+		}
+	} else {
+		for (Index c {0}; c < nChunks; ++c){
+			const int b { static_cast<int>(c % 2) };
+			auto [start, size] { chunkRange(c) };
+			/* the copy from this buffer, two chunks ago, must be done */
+			spaces[b].fence("Kokkidio::Checkpoint::read");
+			file.read( hostBuf[b], fileBytes(size) );
+			auto dst { deviceChunk(b, start, size) };
+			Kokkos::deep_copy( spaces[b], dst, hostChunk(b, size) );
+			if ( !isContiguous ){
+				Kokkos::deep_copy( spaces[b],
+					outerSubview<rowMajor>(view, start, size), dst
+				);
+			}
+		}
+		for ( const auto& space : spaces ){
+			space.fence("Kokkidio::Checkpoint::read");
+		}
+	}
+}
+
+template<typename T>
+inline constexpr bool isCheckpointable_v {
+	is_ViewMap_v<T> || is_DualViewMap_v<T>
+};
+
+} // namespace detail::checkpoint
+
+
+/**
+ * @brief Writes ViewMaps and DualViewMaps to a binary checkpoint file,
+ * one record per call to write(), without first copying them
+ * into Eigen objects on the host.
+ * The records can be read back in the same order with CheckpointReader.
+ *
+ * Data on the target is downloaded in chunks of about @a chunkBytes,
+ * which overlap with writing the previous chunk to the file.
+ * The record count in the file header is updated after each record,
+ * so that the file stays readable, if a later write fails.
+ */
+class CheckpointWriter {
+public:
+	using Header       = detail::checkpoint::FileHeader;
+	using RecordHeader = detail::checkpoint::RecordHeader;
+
+protected:
+	detail::checkpoint::File m_file;
+	std::size_t m_chunkBytes;
+	detail::checkpoint::StreamResources m_resources;
+	Header m_header {};
+
+	void writeHeader(){
+		this->m_file.seek(0, SEEK_SET);
+		this->m_file.write( &(this->m_header), sizeof(Header) );
+		this->m_file.seek(0, SEEK_END);
+	}
+
+public:
+	explicit CheckpointWriter(
+		const std::string& path,
+		std::size_t chunkBytes = detail::checkpoint::defaultChunkBytes
+	) :
+		m_file {path, "wb"},
+		m_chunkBytes {chunkBytes}
+	{
+		std::memcpy( this->m_header.magic, Header::magicValue, sizeof(Header::magicValue) );
+		this->m_header.version = Header::versionValue;
+		this->m_header.records = 0;
+		this->m_file.write( &(this->m_header), sizeof(Header) );
+	}
+
+	std::size_t records() const {
+		return static_cast<std::size_t>(this->m_header.records);
+	}
+
+	/**
+	 * @brief Appends the data of @a obj to the checkpoint.
+	 *
+	 * For a DualViewMap, the target side is written,
+	 * unless only the host side was marked as modified
+	 * (see DualViewMap::modify_host).
+	 * If the target has a different scalar type, the host side is written,
+	 * unless only the target side was marked as modified.
+	 * Then, the target data is converted to the host's scalar type
+	 * while it is written, and the host side is left unchanged.
+	 */
+	template<typename T>
+	void write( const T& obj ){
+		static_assert( detail::checkpoint::isCheckpointable_v<T>,
+			"CheckpointWriter::write requires a ViewMap or DualViewMap."
+		);
+		if constexpr ( is_ViewMap_v<T> ){
+			this->writeRecord<typename T::PlainObjectType>( obj.view() );
+		} else {
+			using P = typename T::ViewMap_host::PlainObjectType;
+			if constexpr (T::aliasesHost){
+				this->writeRecord<P>( obj.view_host() );
+			} else {
+				if ( obj.needsSync_target() ){
+					this->writeRecord<P>( obj.view_host() );
+				} else if constexpr (T::isMixedPrecision){
+					/* the host side has the full precision */
+					if ( obj.needsSync_host() ){
+						this->writeRecord<P>( obj.view_target() );
+					} else {
+						this->writeRecord<P>( obj.view_host() );
+					}
+				} else {
+					this->writeRecord<P>( obj.view_target() );
+				}
+			}
+		}
+	}
+
+protected:
+	template<typename PlainObjectType, typename View>
+	void writeRecord( const View& view ){
+		using P = std::remove_const_t<PlainObjectType>;
+		RecordHeader rec {};
+		rec.scalar   = detail::scalarTag<typename P::Scalar>();
+		rec.rowMajor = P::IsRowMajor ? 1 : 0;
+		rec.rows     = static_cast<std::int64_t>( view.extent(0) );
+		rec.cols     = static_cast<std::int64_t>( view.extent(1) );
+		this->m_file.write( &rec, sizeof(RecordHeader) );
+		detail::checkpoint::stream<true, P::IsRowMajor, typename P::Scalar>(
+			this->m_file, this->m_resources, view, this->m_chunkBytes
+		);
+		++(this->m_header.records);
+		this->writeHeader();
+		this->m_file.flush();
+	}
+};
+
+
+/**
+ * @brief Reads the records of a checkpoint file
+ * written by CheckpointWriter, in the order in which they were written.
+ * The data is restored directly into already allocated
+ * ViewMaps and DualViewMaps, whose scalar type, storage order,
+ * and size must match the record.
+ *
+ * Data for the target is read in chunks of about @a chunkBytes,
+ * and each chunk is copied to the target while the next one is read.
+ */
+class CheckpointReader {
+public:
+	using Header       = detail::checkpoint::FileHeader;
+	using RecordHeader = detail::checkpoint::RecordHeader;
+
+protected:
+	detail::checkpoint::File m_file;
+	std::size_t m_chunkBytes;
+	detail::checkpoint::StreamResources m_resources;
+	Header m_header {};
+	std::uint64_t m_next {0};
+
+public:
+	explicit CheckpointReader(
+		const std::string& path,
+		std::size_t chunkBytes = detail::checkpoint::defaultChunkBytes
+	) :
+		m_file {path, "rb"},
+		m_chunkBytes {chunkBytes}
+	{
+		this->m_file.read( &(this->m_header), sizeof(Header) );
+		if ( std::memcmp(
+				this->m_header.magic, Header::magicValue, sizeof(Header::magicValue)
+			) != 0 ||
+			this->m_header.version != Header::versionValue
+		){
+			this->m_file.invalid("not a Kokkidio checkpoint file.");
+		}
+	}
+
+	std::size_t records() const {
+		return static_cast<std::size_t>(this->m_header.records);
+	}
+
+	/**
+	 * @brief Reads the next record into @a obj.
+	 *
+	 * For a DualViewMap, the data is restored on the target,
+	 * which is then marked as modified (see DualViewMap::modify_target).
+	 * If the target has a different scalar type,
+	 * the data is read into the host side, and copied to the target.
+	 */
+	template<typename T>
+	void read( const T& obj ){
+		static_assert( detail::checkpoint::isCheckpointable_v<T>,
+			"CheckpointReader::read requires a ViewMap or DualViewMap."
+		);
+		if constexpr ( is_ViewMap_v<T> ){
+			static_assert( !std::is_const_v<typename T::Scalar>,
+				"Cannot restore a checkpoint into a const ViewMap."
+			);
+			this->readRecord<typename T::PlainObjectType>( obj.view() );
+		} else {
+			static_assert( !std::is_const_v<typename T::EigenType_host>,
+				"Cannot restore a checkpoint into a const DualViewMap."
+			);
+			using P = typename T::ViewMap_host::PlainObjectType;
+			/* copies share their data and modification state */
+			T dvm {obj};
+			if constexpr (T::aliasesHost){
+				this->readRecord<P>( dvm.view_host() );
+			} else if constexpr (T::isMixedPrecision){
+				this->readRecord<P>( dvm.view_host() );
+				dvm.copyToTarget();
+			} else {
+				this->readRecord<P>( dvm.view_target() );
+				dvm.modify_target();
+			}
+		}
+	}
+
+protected:
+	template<typename PlainObjectType, typename View>
+	void readRecord( const View& view ){
+		using P = std::remove_const_t<PlainObjectType>;
+		if ( this->m_next >= this->m_header.records ){
+			this->m_file.invalid("no more records.");
+		}
+		RecordHeader rec;
+		this->m_file.read( &rec, sizeof(RecordHeader) );
+		auto mismatch = [&](const char* what){
+			this->m_file.invalid( "record " + std::to_string(this->m_next) +
+				": " + what + " mismatch."
+			);
+		};
+		if ( rec.scalar != detail::scalarTag<typename P::Scalar>() ){
+			mismatch("scalar type");
+		}
+		if ( (rec.rowMajor != 0) != P::IsRowMajor ){
+			mismatch("storage order");
+		}
+		if ( rec.rows != static_cast<std::int64_t>( view.extent(0) ) ||
+			rec.cols != static_cast<std::int64_t>( view.extent(1) )
+		){
+			mismatch("size");
+		}
+		detail::checkpoint::stream<false, P::IsRowMajor, typename P::Scalar>(
+			this->m_file, this->m_resources, view, this->m_chunkBytes
+		);
+		++(this->m_next);
+	}
+};
+
+/**
+ * @brief Writes all @a objs to a new checkpoint file at @a path.
+ */
+template<typename... Objs>
+void writeCheckpoint( const std::string& path, const Objs&... objs ){
+	CheckpointWriter writer {path};
+	( writer.write(objs), ... );
+}
+
+/**
+ * @brief Restores all @a objs from the checkpoint file at @a path,
+ * which must have been written with the same objects, in the same order.
+ */
+template<typename... Objs>
+void readCheckpoint( const std::string& path, const Objs&... objs ){
+	CheckpointReader reader {path};
+	if ( reader.records() != sizeof...(Objs) ){
+		throw std::runtime_error( "Checkpoint (" + path + "): expected " +
+			std::to_string( sizeof...(Objs) ) + " records, found " +
+			std::to_string( reader.records() ) + "."
+		);
+	}
+	( reader.read(objs), ... );
+}
+
+} // namespace Kokkidio
+
+#endif
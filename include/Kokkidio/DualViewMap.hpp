@@ -6,6 +6,12 @@
 #endif
 
 #include "Kokkidio/ViewMap.hpp"
+#include "Kokkidio/LayoutPolicy.hpp"
+#include "Kokkidio/IndexRange_base.hpp"
+#include "Kokkidio/TransferHandle.hpp"
+#include "Kokkidio/TransferCodec.hpp"
+
+#include <algorithm>
 
 namespace Kokkidio
 {
@@ -17,16 +23,178 @@ enum DualViewCopyOnInit {
 	CopyToTarget = 1,
 };
 
+/**
+ * @brief Declares how the data returned by DualViewMap::map_host(DualViewAccess)
+ * and DualViewMap::map_target(DualViewAccess) is going to be used.
+ * Reading requires the requested side to be up to date,
+ * so it is synchronised first, if necessary.
+ * Writing marks the requested side as modified.
+ */
+enum DualViewAccess {
+	ReadOnly  = 1,
+	WriteOnly = 2,
+	ReadWrite = ReadOnly | WriteOnly,
+};
+
+template<Target _target>
+class EigenRange;
+
+template<Target targetArg, typename... EigenTypes>
+class DualViewMapGroup;
+
+namespace detail
+{
+
+/* Which dimension a range refers to in partial copies.
+ * "automatic" follows the same rule as Kokkidio::autoRange,
+ * i.e. rows for column vectors, and columns otherwise. */
+enum class RangeDim {
+	rows,
+	cols,
+	automatic,
+};
+
+/* Hints the backend to migrate shared memory to the device,
+ * or back to the host. Errors are ignored, because this is only a hint,
+ * e.g. not all devices support prefetching.
+ * Without a backend which supports it, this does nothing. */
+template<bool toTarget, typename Space>
+void prefetchShared(
+	[[maybe_unused]] const Space& space,
+	[[maybe_unused]] const void* data,
+	[[maybe_unused]] std::size_t bytes
+){
+	#if defined(KOKKOS_ENABLE_CUDA)
+	if constexpr ( std::is_same_v<Space, Kokkos::Cuda> ){
+		#if CUDART_VERSION >= 13000
+		cudaMemLocation location {};
+		location.type = toTarget ? cudaMemLocationTypeDevice : cudaMemLocationTypeHost;
+		location.id   = toTarget ? space.cuda_device() : 0;
+		if ( cudaMemPrefetchAsync( data, bytes, location, 0, space.cuda_stream() )
+		#else
+		if ( cudaMemPrefetchAsync( data, bytes,
+			toTarget ? space.cuda_device() : cudaCpuDeviceId, space.cuda_stream() )
+		#endif
+			!= cudaSuccess
+		){
+			(void) cudaGetLastError();
+		}
+	}
+	#elif defined(KOKKOS_ENABLE_HIP)
+	if constexpr ( std::is_same_v<Space, Kokkos::HIP> ){
+		if ( hipMemPrefetchAsync( data, bytes,
+			toTarget ? space.hip_device() : hipCpuDeviceId, space.hip_stream()
+			) != hipSuccess
+		){
+			(void) hipGetLastError();
+		}
+	}
+	#endif
+}
 
-template<typename _EigenType, Target targetArg = DefaultTarget>
+/* Modification counters in the style of Kokkos::DualView:
+ * whichever side has the higher count holds the most recent data.
+ * If both are equal, then no synchronisation is required. */
+struct DualViewSyncState {
+	unsigned int
+		modified_host   {0},
+		modified_target {0};
+	std::size_t skipped {0};
+};
+
+} // namespace detail
+
+
+/**
+ * @brief Holds an Eigen object's data on both host and target.
+ * 
+ * @tparam _EigenType 
+ * @tparam targetArg 
+ * @tparam _layoutPolicy is applied to the target side only,
+ * while the host side keeps the storage order of @a _EigenType.
+ * With LayoutPolicy::soa, the target data of e.g. an ArrayNXs<3>
+ * is stored row by row, and transposed during transfers.
+ * With LayoutPolicy::padded, every target column starts on a cache line,
+ * and the padding is added and removed during transfers.
+ * If the target is the host, the policy has no effect.
+ * @tparam _hostMemory selects the memory space of the host side,
+ * when the DualViewMap allocates it (i.e. when it does not wrap an Eigen object).
+ * With HostMemoryPolicy::pinned, transfers use page-locked memory.
+ * If the target is the host, the policy has no effect,
+ * except for HostMemoryPolicy::hugepages.
+ * With HostMemoryPolicy::shared, the DualViewMap allocates a single
+ * shared View, and the host side wraps it. Then, copyToTarget() and
+ * copyToHost() do not copy, but only prefetch the data,
+ * and copyToHost() waits for the target to finish.
+ * When wrapping an Eigen object, the target side is allocated separately
+ * (in shared memory), and copies remain copies.
+ * @tparam _Scalar_target is the scalar type of the target side,
+ * e.g. float for a double precision host object.
+ * Then, the data is converted on the host during transfers,
+ * so that only the target's scalar type is transferred
+ * (converting on the target would transfer the host's scalar type instead).
+ * The conversion is part of packing the data into a pinned buffer,
+ * which is kept for subsequent transfers.
+ * Unlike the other parameters, it also applies if the target is the host,
+ * in which case both sides are allocated separately.
+ */
+template<
+	typename _EigenType,
+	Target targetArg = DefaultTarget,
+	LayoutPolicy _layoutPolicy = LayoutPolicy::aos,
+	HostMemoryPolicy _hostMemory = HostMemoryPolicy::pageable,
+	typename _Scalar_target = typename std::remove_const_t<_EigenType>::Scalar
+>
 class DualViewMap {
 public:
 	static constexpr Target target { ExecutionTarget<targetArg> };
+	static constexpr LayoutPolicy layoutPolicy {
+		target == Target::host ? LayoutPolicy::aos : _layoutPolicy
+	};
+	static constexpr HostMemoryPolicy hostMemory {
+		_hostMemory == HostMemoryPolicy::shared ?
+			detail::hostMemoryPolicy<target, _hostMemory> :
+			( target == Target::host && _hostMemory != HostMemoryPolicy::hugepages ?
+				HostMemoryPolicy::pageable : _hostMemory )
+	};
 	using EigenType_host = _EigenType;
+	using Scalar_host   = typename std::remove_const_t<EigenType_host>::Scalar;
+	using Scalar_target = _Scalar_target;
+	static constexpr bool isMixedPrecision {
+		!std::is_same_v<Scalar_host, Scalar_target>
+	};
+	/* Whether the target side uses the same data as the host side,
+	 * because the target is the host */
+	static constexpr bool aliasesHost {
+		target == Target::host && !isMixedPrecision
+	};
+	/* Whether a DualViewMap which allocates its memory
+	 * uses a single shared View on the device */
+	static constexpr bool sharesMemory {
+		target != Target::host && !isMixedPrecision &&
+		hostMemory == HostMemoryPolicy::shared
+	};
 
-	using ThisType = DualViewMap<EigenType_host, target>;
-	using ViewMap_host   = ViewMap<EigenType_host, Target::host>;
-	using ViewMap_target = ViewMap<EigenType_host, target>;
+	using ThisType = DualViewMap<
+		EigenType_host, target, layoutPolicy, hostMemory, Scalar_target
+	>;
+	using ViewMap_host   = ViewMap<EigenType_host, Target::host, hostMemory>;
+	/* With mixed precision, the target side is always a separate allocation,
+	 * which must be writeable to convert the data into it,
+	 * even on the host */
+	using ViewMap_target = ViewMap<
+		std::conditional_t<isMixedPrecision,
+			layout_policy_t<
+				std::remove_const_t<with_scalar_t<EigenType_host, Scalar_target>>,
+				layoutPolicy
+			>,
+			layout_policy_t<EigenType_host, layoutPolicy>
+		>,
+		target,
+		hostMemory == HostMemoryPolicy::shared ||
+		hostMemory == HostMemoryPolicy::hugepages ?
+			hostMemory : HostMemoryPolicy::pageable
+	>;
 	using EigenType_target = typename ViewMap_target::EigenType_target;
 	using Scalar = typename ViewMap_target::Scalar;
 
@@ -42,17 +210,117 @@ public:
 		is_eigen_map        <std::remove_const_t<EigenType_target>>::value
 	);
 
+	static_assert( !sharesMemory || layoutPolicy == LayoutPolicy::aos,
+		"HostMemoryPolicy::shared requires the same layout on host and target."
+	);
+
+	using SyncStateView = Kokkos::View<detail::DualViewSyncState, Kokkos::HostSpace>;
+	using ConversionBuffer = Kokkos::View<
+		std::remove_const_t<Scalar_target>*,
+		MemorySpace<Target::host, HostMemoryPolicy::pinned>
+	>;
+
 protected:
 	ViewMap_host   m_host;
 	ViewMap_target m_target;
+	/* The sync state is stored in a View, so that it is shared between
+	 * copies of a DualViewMap, e.g. those captured by a KOKKOS_LAMBDA.
+	 * It is allocated along with the data (see clearSyncState),
+	 * so that an empty DualViewMap allocates nothing,
+	 * and may be declared before Kokkos is initialised.
+	 * Without a sync state, both sides count as unmodified. */
+	SyncStateView m_sync;
+	/* With mixed precision, the pinned buffer for converted copies.
+	 * Allocated on the first transfer, and grown when a larger one is needed */
+	ConversionBuffer m_conversionBuf;
+	/* Buffers of encoded copies, see copyToTarget(TransferCodec).
+	 * Allocated on the first encoded copy, and grown when a larger one is needed */
+	detail::codec::Buffer<Kokkos::DefaultHostExecutionSpace> m_codecBuf_host;
+	detail::codec::Buffer<ExecutionSpace_target> m_codecBuf_target;
+
+	bool hasSyncState() const {
+		return this->m_sync.is_allocated();
+	}
+
+	auto syncState() -> detail::DualViewSyncState& {
+		if ( !this->hasSyncState() ){
+			this->m_sync = SyncStateView{"DualViewMap::syncState"};
+		}
+		return this->m_sync();
+	}
+
+	auto syncState() const -> detail::DualViewSyncState {
+		return this->hasSyncState() ?
+			this->m_sync() : detail::DualViewSyncState{};
+	}
+
+	/* Called whenever the DualViewMap gets new data or copies it,
+	 * which is also when the sync state is allocated */
+	void clearSyncState(){
+		auto& state { this->syncState() };
+		state.modified_host   = 0;
+		state.modified_target = 0;
+	}
+
+	template<Target, typename...>
+	friend class DualViewMapGroup;
+
+	/* Combines existing host and target sides of equal size,
+	 * e.g. parts of the allocations of a DualViewMapGroup.
+	 * No data is copied. */
+	DualViewMap( const ViewMap_host& hostSide, const ViewMap_target& targetSide ) :
+		m_host  (hostSide),
+		m_target(targetSide)
+	{
+		assert( this->m_host.rows() == this->m_target.rows() );
+		assert( this->m_host.cols() == this->m_target.cols() );
+		this->modify_host();
+	}
+
+	/* The target ViewMap can only wrap the host object
+	 * if both use the same storage order */
+	static auto makeTarget( EigenType_host& hostObj ) -> ViewMap_target {
+		if constexpr ( std::is_same_v<
+			typename ViewMap_target::EigenType_host, EigenType_host
+		> ){
+			return {hostObj};
+		} else {
+			return { hostObj.rows(), hostObj.cols() };
+		}
+	}
+
+	/* With shared memory, the target side owns the allocation,
+	 * and the host side wraps it. */
+	void wrapTarget(){
+		static_assert(sharesMemory);
+		if ( !this->m_target.view().data() ){
+			this->m_host = {};
+			return;
+		}
+		this->m_host = { this->m_target.view().data(),
+			this->m_target.rows(), this->m_target.cols()
+		};
+	}
+
+	/* False if the host side wraps an Eigen object or external memory,
+	 * which is not shared with the target */
+	bool isShared() const {
+		return this->m_host.view().data() == this->m_target.view().data();
+	}
 
 	void set(Index rows, Index cols){
+		this->clearSyncState();
+		if constexpr (sharesMemory){
+			m_target = {rows, cols};
+			this->wrapTarget();
+			return;
+		}
 		m_host = {rows, cols};
 		/* When target and host are identical, 
 		 * then we can copy-initialise the target View with the host View
 		 * (or vice versa), to make them point to the same data.
 		 */
-		if constexpr (target == Target::host){
+		if constexpr (aliasesHost){
 			m_target = {m_host};
 		} else {
 			m_target = {rows, cols};
@@ -77,10 +345,34 @@ public:
 		DualViewCopyOnInit copyToTarget = CopyToTarget
 	) :
 		m_host  (hostObj),
-		m_target(hostObj)
+		m_target( makeTarget(hostObj) )
+	{
+		if ( copyToTarget ){
+			this->copyToTarget();
+		} else {
+			/* only the host object holds meaningful data */
+			this->modify_host();
+		}
+	}
+
+	/* Like DualViewMap(EigenType_host&, DualViewCopyOnInit),
+	 * but for raw host memory (e.g. from a MappedFile),
+	 * which must outlive the DualViewMap. */
+	DualViewMap(
+		typename ViewMap_host::Scalar_host* hostData, Index rows, Index cols,
+		DualViewCopyOnInit copyToTarget = CopyToTarget
+	) :
+		m_host(hostData, rows, cols)
 	{
+		if constexpr (aliasesHost){
+			m_target = {m_host};
+		} else {
+			m_target = {rows, cols};
+		}
 		if ( copyToTarget ){
 			this->copyToTarget();
+		} else {
+			this->modify_host();
 		}
 	}
 
@@ -101,13 +393,23 @@ public:
 
 	void assign( EigenType_host& hostObj ){
 		this->m_host   = {hostObj};
-		this->m_target = {hostObj};
+		this->m_target = makeTarget(hostObj);
+		this->clearSyncState();
+		this->modify_host();
 	}
 
 	void resize( Index rows, Index cols ){
 		/* the logic here is analogous to DualViewMap::set */
+		this->clearSyncState();
+		if constexpr (sharesMemory){
+			if ( this->isShared() ){
+				this->m_target.resize(rows, cols);
+				this->wrapTarget();
+				return;
+			}
+		}
 		this->m_host.resize(rows, cols);
-		if constexpr (target == Target::host){
+		if constexpr (aliasesHost){
 			m_target = {m_host};
 		} else {
 			this->m_target.resize(rows, cols);
@@ -124,6 +426,38 @@ public:
 		this->resize( obj.rows(), obj.cols() );
 	}
 
+	/* See ViewMap::reserve */
+	void reserve( Index rows, Index cols ){
+		if constexpr (sharesMemory){
+			if ( this->isShared() ){
+				this->m_target.reserve(rows, cols);
+				this->wrapTarget();
+				return;
+			}
+		}
+		this->m_host.reserve(rows, cols);
+		if constexpr (aliasesHost){
+			m_target = {m_host};
+		} else {
+			this->m_target.reserve(rows, cols);
+		}
+	}
+
+	void reserve(Index size){
+		static_assert(EigenType_host::IsVectorAtCompileTime);
+		this->reserve(size, size);
+	}
+
+	KOKKOS_FUNCTION
+	Index capacity_host() const {
+		return this->m_host.capacity();
+	}
+
+	KOKKOS_FUNCTION
+	Index capacity_target() const {
+		return this->m_target.capacity();
+	}
+
 	KOKKOS_FUNCTION
 	bool isAlloc_host() const {
 		return this->m_host.isAlloc();
@@ -202,6 +536,56 @@ public:
 		return this->map_target();
 	}
 
+	/* see ViewMap::map_unchecked() */
+	KOKKOS_FUNCTION
+	auto map_host_unchecked() const -> MapType_host {
+		return this->m_host.map_unchecked();
+	}
+
+	/* see ViewMap::map_unchecked() */
+	KOKKOS_FUNCTION
+	auto map_target_unchecked() const -> MapType_target {
+		return this->m_target.map_unchecked();
+	}
+
+	/**
+	 * @brief Host-only accessor which synchronises lazily.
+	 * With DualViewAccess::ReadOnly or DualViewAccess::ReadWrite,
+	 * the host data is updated first, if the target was modified.
+	 * With DualViewAccess::WriteOnly or DualViewAccess::ReadWrite,
+	 * the host data is marked as modified.
+	 * 
+	 * @param access 
+	 * @return MapType_host 
+	 */
+	auto map_host(DualViewAccess access) -> MapType_host {
+		if (access & ReadOnly){
+			this->sync_host();
+		}
+		if (access & WriteOnly){
+			this->modify_host();
+		}
+		return this->map_host();
+	}
+
+	/**
+	 * @brief Host-only accessor which synchronises lazily.
+	 * Same as map_host(DualViewAccess), but for the target data.
+	 * The returned Eigen::Map can then be captured by a KOKKOS_LAMBDA.
+	 * 
+	 * @param access 
+	 * @return MapType_target 
+	 */
+	auto map_target(DualViewAccess access) -> MapType_target {
+		if (access & ReadOnly){
+			this->sync_target();
+		}
+		if (access & WriteOnly){
+			this->modify_target();
+		}
+		return this->map_target();
+	}
+
 	template<Target _target>
 	KOKKOS_FUNCTION
 	auto map() const -> 
@@ -230,51 +614,527 @@ public:
 		return static_cast<Index>( this->view().size() );
 	}
 
+	/**
+	 * @brief Marks the host data as modified,
+	 * so that the next call to sync_target() copies it to the target.
+	 */
+	void modify_host(){
+		auto& state { this->syncState() };
+		state.modified_host = std::max(
+			state.modified_host, state.modified_target
+		) + 1;
+	}
+
+	/**
+	 * @brief Marks the target data as modified,
+	 * so that the next call to sync_host() copies it to the host.
+	 */
+	void modify_target(){
+		auto& state { this->syncState() };
+		state.modified_target = std::max(
+			state.modified_host, state.modified_target
+		) + 1;
+	}
+
+	bool needsSync_host() const {
+		if constexpr (aliasesHost){
+			return false;
+		} else {
+			const auto state { this->syncState() };
+			return state.modified_target > state.modified_host;
+		}
+	}
+
+	bool needsSync_target() const {
+		if constexpr (aliasesHost){
+			return false;
+		} else {
+			const auto state { this->syncState() };
+			return state.modified_host > state.modified_target;
+		}
+	}
+
+	/**
+	 * @brief Copies the target data to the host,
+	 * if it was marked as modified via modify_target().
+	 * Otherwise, the call is counted as a skipped sync.
+	 */
+	void sync_host(bool async = false){
+		if ( this->needsSync_host() ){
+			this->copyToHost(async);
+		} else {
+			printd("DualViewMap::sync_host, host is up to date, skipping...\n");
+			++( this->syncState().skipped );
+		}
+	}
+
+	/**
+	 * @brief Copies the host data to the target,
+	 * if it was marked as modified via modify_host().
+	 * Otherwise, the call is counted as a skipped sync.
+	 */
+	void sync_target(bool async = false){
+		if ( this->needsSync_target() ){
+			this->copyToTarget(async);
+		} else {
+			printd("DualViewMap::sync_target, target is up to date, skipping...\n");
+			++( this->syncState().skipped );
+		}
+	}
+
+	/**
+	 * @brief Returns the number of calls to sync_host() and sync_target()
+	 * (including those via map_host/map_target(DualViewAccess)),
+	 * which did not require a copy.
+	 */
+	std::size_t skippedSyncs() const {
+		return this->syncState().skipped;
+	}
+
+	/* copyToTarget and copyToHost always copy,
+	 * regardless of the modification state, and afterwards,
+	 * both sides are considered to be in sync. */
 	void copyToTarget(bool async = false){
-		if constexpr ( target != Target::host ){
-			printd( "Copying from host (n=%i) to target (n=%i)...\n"
-				, static_cast<int>( this->view_host  ().size() )
-				, static_cast<int>( this->view_target().size() )
-			);
-			if (async){
-				Kokkos::deep_copy( ExecutionSpace_target{},
-					this->view_target(), // dst
-					this->view_host()    // src
-				);
+		this->copyAll<true>(async);
+	}
+
+	void copyToHost(bool async = false){
+		this->copyAll<false>(async);
+	}
+
+	/**
+	 * @brief Enqueues a copy from host to target on the execution space
+	 * instance @a space, and returns a handle to wait on. 
+	 * Kernels dispatched on the same instance are ordered after the copy,
+	 * e.g. via Kokkidio::parallel_for(handle, policy, func).
+	 * The host data must not be modified until the copy has finished.
+	 */
+	auto copyToTarget(const ExecutionSpace_target& space)
+		-> TransferHandle<ExecutionSpace_target>
+	{
+		this->copyAll<true>(space);
+		this->recordUse(space);
+		return {space};
+	}
+
+	/**
+	 * @brief Enqueues a copy from target to host on the execution space
+	 * instance @a space, and returns a handle to wait on. 
+	 * The host data must not be accessed until the copy has finished.
+	 */
+	auto copyToHost(const ExecutionSpace_target& space)
+		-> TransferHandle<ExecutionSpace_target>
+	{
+		this->copyAll<false>(space);
+		this->recordUse(space);
+		return {space};
+	}
+
+	/**
+	 * @brief Copies all data from host to target,
+	 * encoded with @a codec on the host, and decoded on the target,
+	 * see TransferCodec. The copy is synchronous.
+	 * Falls back to copyToTarget(), if the data cannot be transferred
+	 * as a contiguous block, e.g. for strided host data,
+	 * a different layout or scalar type on the target,
+	 * or when host and target share their memory.
+	 */
+	void copyToTarget(TransferCodec codec){
+		this->encodedCopy<true>(codec);
+	}
+
+	/**
+	 * @brief Same as copyToTarget(TransferCodec),
+	 * but encodes on the target, and decodes on the host.
+	 */
+	void copyToHost(TransferCodec codec){
+		this->encodedCopy<false>(codec);
+	}
+
+	/* Partial copies only transfer the columns (or rows) in a range.
+	 * For column-major types, a column range is contiguous,
+	 * so the transfer volume is proportional to the range size.
+	 * Row ranges of matrices are strided, and have to be staged
+	 * in contiguous buffers, which makes them slower to copy.
+	 * For row-major types, it is the other way around.
+	 * The modification state is not changed by partial copies,
+	 * because the remaining data may still differ. */
+
+	/**
+	 * @brief Copies part of the host data to the target.
+	 * @a rng refers to the same dimension as in Kokkidio::autoRange,
+	 * i.e. rows for column vectors, and columns otherwise.
+	 */
+	void copyToTarget(const IndexRange<Index>& rng, bool async = false){
+		this->copyRange<true, detail::RangeDim::automatic>(rng, async);
+	}
+
+	void copyToHost(const IndexRange<Index>& rng, bool async = false){
+		this->copyRange<false, detail::RangeDim::automatic>(rng, async);
+	}
+
+	template<Target _target>
+	void copyToTarget(const EigenRange<_target>& rng, bool async = false){
+		this->copyToTarget(rng.asIndexRange(), async);
+	}
+
+	template<Target _target>
+	void copyToHost(const EigenRange<_target>& rng, bool async = false){
+		this->copyToHost(rng.asIndexRange(), async);
+	}
+
+	auto copyToTarget(
+		const ExecutionSpace_target& space, const IndexRange<Index>& rng
+	) -> TransferHandle<ExecutionSpace_target> {
+		this->copyRange<true, detail::RangeDim::automatic>(rng, space);
+		this->recordUse(space);
+		return {space};
+	}
+
+	auto copyToHost(
+		const ExecutionSpace_target& space, const IndexRange<Index>& rng
+	) -> TransferHandle<ExecutionSpace_target> {
+		this->copyRange<false, detail::RangeDim::automatic>(rng, space);
+		this->recordUse(space);
+		return {space};
+	}
+
+	void copyColsToTarget(const IndexRange<Index>& cols, bool async = false){
+		this->copyRange<true, detail::RangeDim::cols>(cols, async);
+	}
+
+	void copyColsToHost(const IndexRange<Index>& cols, bool async = false){
+		this->copyRange<false, detail::RangeDim::cols>(cols, async);
+	}
+
+	void copyRowsToTarget(const IndexRange<Index>& rows, bool async = false){
+		this->copyRange<true, detail::RangeDim::rows>(rows, async);
+	}
+
+	void copyRowsToHost(const IndexRange<Index>& rows, bool async = false){
+		this->copyRange<false, detail::RangeDim::rows>(rows, async);
+	}
+
+protected:
+	/* With a bool, Kokkos::deep_copy is either called synchronously,
+	 * or asynchronously on the default instance of the target's
+	 * execution space.
+	 * With an execution space instance, it is always enqueued there. */
+	template<typename Dst, typename Src>
+	void deepCopy( const Dst& dst, const Src& src, bool async ){
+		if constexpr (isMixedPrecision){
+			this->convertedCopy( dst, src, ExecutionSpace_target{} );
+		} else
+		if ( !isDirectCopy(dst, src) ){
+			stagedCopy( dst, src, ExecutionSpace_target{} );
+		} else if (async){
+			Kokkos::deep_copy( ExecutionSpace_target{}, dst, src );
+		} else {
+			Kokkos::deep_copy( dst, src );
+		}
+	}
+
+	template<typename Dst, typename Src>
+	void deepCopy(
+		const Dst& dst, const Src& src, const ExecutionSpace_target& space
+	){
+		if constexpr (isMixedPrecision){
+			this->convertedCopy( dst, src, space );
+		} else
+		if ( !isDirectCopy(dst, src) ){
+			stagedCopy( dst, src, space );
+		} else {
+			Kokkos::deep_copy( space, dst, src );
+		}
+	}
+
+	/* Kokkos only copies directly between memory spaces,
+	 * if both Views have the same layout and are contiguous.
+	 * That is not the case for strided host data (e.g. Eigen::OuterStride),
+	 * or for row ranges of column-major matrices. */
+	template<typename Dst, typename Src>
+	static bool isDirectCopy( const Dst& dst, const Src& src ){
+		return
+			std::is_same_v<typename Dst::array_layout, typename Src::array_layout> &&
+			dst.span_is_contiguous() &&
+			src.span_is_contiguous();
+	}
+
+	template<typename View>
+	static auto stagingView( const View& view ){
+		using S = typename View::non_const_value_type;
+		return Kokkos::View<S**, Kokkos::LayoutLeft, typename View::memory_space>{
+			Kokkos::view_alloc( Kokkos::WithoutInitializing,
+				"DualViewMap::stagingView"
+			),
+			view.extent(0),
+			view.extent(1)
+		};
+	}
+
+	template<typename View>
+	static bool isStagingCompatible( const View& view ){
+		return
+			std::is_same_v<typename View::array_layout, Kokkos::LayoutLeft> &&
+			view.span_is_contiguous();
+	}
+
+	/* Packs the data into a contiguous buffer on the source side,
+	 * transfers it to a contiguous buffer on the destination side,
+	 * and unpacks it there. 
+	 * Sides which are already contiguous and LayoutLeft are used directly,
+	 * so that e.g. for LayoutPolicy::soa, the transposition
+	 * only happens on the target.
+	 * Staged copies are always synchronous, 
+	 * because the buffers are released on return. */
+	template<typename Dst, typename Src>
+	static void stagedCopy(
+		const Dst& dst, const Src& src, const ExecutionSpace_target& space
+	){
+		printd( "DualViewMap: staging non-contiguous copy, size %i x %i.\n"
+			, static_cast<int>( dst.extent(0) )
+			, static_cast<int>( dst.extent(1) )
+		);
+		auto transfer = [&]( const auto& srcBuf ){
+			if ( isStagingCompatible(dst) ){
+				Kokkos::deep_copy( space, dst, srcBuf );
+				space.fence( "Kokkidio::DualViewMap::stagedCopy" );
 			} else {
-				Kokkos::deep_copy(
-					this->view_target(), // dst
-					this->view_host()    // src
+				auto dstBuf { stagingView(dst) };
+				Kokkos::deep_copy( space, dstBuf, srcBuf );
+				space.fence( "Kokkidio::DualViewMap::stagedCopy" );
+				Kokkos::deep_copy( dst, dstBuf );
+			}
+		};
+		if ( isStagingCompatible(src) ){
+			transfer(src);
+		} else {
+			auto srcBuf { stagingView(src) };
+			Kokkos::deep_copy( srcBuf, src );
+			transfer(srcBuf);
+		}
+	}
+
+	/* With HostMemoryPolicy::shared, there is nothing to copy,
+	 * so the data is only prefetched to its destination.
+	 * Afterwards, the host may access the data,
+	 * so prefetches to the host wait for the target, like a copy would.
+	 * Without a device, this only fences the host. */
+	template<bool toTarget, typename View>
+	static void prefetch( const View& view, bool async ){
+		prefetch<toTarget>( view, ExecutionSpace_target{} );
+		if ( !toTarget && !async ){
+			Kokkos::fence("Kokkidio::DualViewMap::prefetch");
+		}
+	}
+
+	template<bool toTarget, typename View>
+	static void prefetch( const View& view, const ExecutionSpace_target& space ){
+		printd( "DualViewMap: shared memory, prefetching to %s...\n"
+			, toTarget ? "target" : "host"
+		);
+		detail::prefetchShared<toTarget>( space, view.data(),
+			view.span() * sizeof(typename View::value_type)
+		);
+	}
+
+	/* Element-wise conversion between host-accessible Views
+	 * of different scalar types, parallelised over the columns */
+	template<typename Dst, typename Src>
+	static void convert( const Dst& dst, const Src& src ){
+		using S = typename Dst::non_const_value_type;
+		using HostSpace = Kokkos::DefaultHostExecutionSpace;
+		assert( dst.extent(0) == src.extent(0) && dst.extent(1) == src.extent(1) );
+		const int rows { static_cast<int>( dst.extent(0) ) };
+		Kokkos::parallel_for( "Kokkidio::DualViewMap::convert",
+			Kokkos::RangePolicy<HostSpace>( 0, static_cast<int>( dst.extent(1) ) ),
+			[=](int j){
+				for (int i {0}; i < rows; ++i){
+					dst(i, j) = static_cast<S>( src(i, j) );
+				}
+			}
+		);
+		HostSpace{}.fence("Kokkidio::DualViewMap::convert");
+	}
+
+	/* Copies between the host side and a target side of a different
+	 * scalar type (see _Scalar_target). The conversion happens on the host,
+	 * while packing into (or unpacking from) a contiguous buffer
+	 * of the target's scalar type, so that only that type is transferred.
+	 * The buffer is pinned, and kept in m_conversionBuf for the next copy.
+	 * Like staged copies, converted copies are always synchronous,
+	 * which also makes it safe to reuse the buffer. */
+	template<typename Dst, typename Src>
+	void convertedCopy(
+		const Dst& dst, const Src& src, const ExecutionSpace_target& space
+	){
+		if constexpr (target == Target::host){
+			convert(dst, src);
+		} else {
+			constexpr bool toTarget { std::is_same_v<
+				typename Src::non_const_value_type, Scalar_host
+			> };
+			const std::size_t size { dst.extent(0) * dst.extent(1) };
+			if ( this->m_conversionBuf.size() < size ){
+				printd( "DualViewMap: allocating conversion buffer, size %i.\n"
+					, static_cast<int>(size)
 				);
+				/* release the old buffer first */
+				this->m_conversionBuf = {};
+				this->m_conversionBuf = ConversionBuffer{
+					Kokkos::view_alloc( Kokkos::WithoutInitializing,
+						"DualViewMap::conversionBuffer"
+					),
+					size
+				};
+			}
+			Kokkos::View<
+				typename ConversionBuffer::non_const_value_type**,
+				Kokkos::LayoutLeft,
+				typename ConversionBuffer::memory_space,
+				Kokkos::MemoryTraits<Kokkos::Unmanaged>
+			> buf { this->m_conversionBuf.data(), dst.extent(0), dst.extent(1) };
+			printd( "DualViewMap: converting copy, size %i x %i.\n"
+				, static_cast<int>( buf.extent(0) )
+				, static_cast<int>( buf.extent(1) )
+			);
+			if constexpr (toTarget){
+				convert(buf, src);
+				stagedCopy(dst, buf, space);
+			} else {
+				stagedCopy(buf, src, space);
+				convert(dst, buf);
+			}
+		}
+	}
+
+	/* Lets the CachingAllocator fence only @a space,
+	 * before either side's memory is reused */
+	void recordUse(const ExecutionSpace_target& space) const {
+		this->m_host  .recordUse(space);
+		this->m_target.recordUse(space);
+	}
+
+	template<bool toTarget, typename CopyArg>
+	void copyAll( [[maybe_unused]] const CopyArg& arg ){
+		this->clearSyncState();
+		if constexpr ( hostMemory == HostMemoryPolicy::shared ){
+			if ( this->isShared() ){
+				prefetch<toTarget>( this->view_target(), arg );
+				return;
+			}
+		}
+		if constexpr ( !aliasesHost ){
+			printd( "Copying from %s (n=%i) to %s (n=%i)...\n"
+				, toTarget ? "host" : "target"
+				, static_cast<int>( toTarget ?
+					this->view_host  ().size() :
+					this->view_target().size()
+				)
+				, toTarget ? "target" : "host"
+				, static_cast<int>( toTarget ?
+					this->view_target().size() :
+					this->view_host  ().size()
+				)
+			);
+			if constexpr (toTarget){
+				deepCopy( this->view_target(), this->view_host(), arg );
+			} else {
+				deepCopy( this->view_host(), this->view_target(), arg );
 			}
 		} else {
-			printd( "DualViewMap::copyToTarget, target==host, skipping...\n");
+			printd( "DualViewMap::copyTo%s, target==host, skipping...\n"
+				, toTarget ? "Target" : "Host"
+			);
 			assert( this->view_target().data() == this->view_host().data() );
 			assert( this-> map_target().data() == this-> map_host().data() );
 		}
 	}
 
-	void copyToHost(bool async = false){
-		if constexpr ( target != Target::host ){
-			printd( "Copying from target (n=%i) to host (n=%i)...\n"
-				, static_cast<int>( this->view_target().size() )
-				, static_cast<int>( this->view_host  ().size() )
-			);
-			if (async){
-				Kokkos::deep_copy( ExecutionSpace_target{},
-					this->view_host(),  // dst
-					this->view_target() // src
+	template<bool toTarget>
+	void encodedCopy( [[maybe_unused]] TransferCodec codec ){
+		if constexpr ( aliasesHost || isMixedPrecision ){
+			this->copyAll<toTarget>(false);
+		} else {
+			bool encodable {
+				codec != TransferCodec::none &&
+				isDirectCopy( this->view_target(), this->view_host() )
+			};
+			if constexpr ( hostMemory == HostMemoryPolicy::shared ){
+				encodable = encodable && !this->isShared();
+			}
+			if ( !encodable ){
+				this->copyAll<toTarget>(false);
+				return;
+			}
+			this->clearSyncState();
+			using HostSpace = Kokkos::DefaultHostExecutionSpace;
+			namespace codecs = detail::codec;
+			if constexpr (toTarget){
+				codecs::transfer<HostSpace, ExecutionSpace_target>( codec,
+					this->view_target().data(), this->view_host().data(),
+					this->view_host().size(),
+					this->m_codecBuf_host, this->m_codecBuf_target
 				);
 			} else {
-				Kokkos::deep_copy(
-					this->view_host(),  // dst
-					this->view_target() // src
+				codecs::transfer<ExecutionSpace_target, HostSpace>( codec,
+					this->view_host().data(), this->view_target().data(),
+					this->view_target().size(),
+					this->m_codecBuf_target, this->m_codecBuf_host
 				);
 			}
+		}
+	}
+
+	template<detail::RangeDim dim, typename ViewType>
+	static auto subview( const ViewType& view, const IndexRange<Index>& rng ){
+		using RD = detail::RangeDim;
+		constexpr bool useRows {
+			dim == RD::rows || (
+				dim == RD::automatic &&
+				EigenType_host::ColsAtCompileTime == 1
+			)
+		};
+		auto pair { Kokkos::make_pair(
+			static_cast<std::size_t>( rng.begin() ),
+			static_cast<std::size_t>( rng.end() )
+		) };
+		if constexpr (useRows){
+			return Kokkos::subview(view, pair, Kokkos::ALL);
+		} else {
+			return Kokkos::subview(view, Kokkos::ALL, pair);
+		}
+	}
+
+	template<bool toTarget, detail::RangeDim dim, typename CopyArg>
+	void copyRange(
+		[[maybe_unused]] const IndexRange<Index>& rng,
+		[[maybe_unused]] const CopyArg& arg
+	){
+		if constexpr ( hostMemory == HostMemoryPolicy::shared ){
+			if ( this->isShared() ){
+				prefetch<toTarget>( subview<dim>( this->view_target(), rng ), arg );
+				return;
+			}
+		}
+		if constexpr ( !aliasesHost ){
+			assert( rng.start() >= 0 && rng.size() >= 0 );
+			auto sub_host   { subview<dim>( this->view_host  (), rng ) };
+			auto sub_target { subview<dim>( this->view_target(), rng ) };
+			printd( "Copying range [%i, %i) from %s to %s...\n"
+				, static_cast<int>( rng.begin() )
+				, static_cast<int>( rng.end() )
+				, toTarget ? "host" : "target"
+				, toTarget ? "target" : "host"
+			);
+			if constexpr (toTarget){
+				deepCopy( sub_target, sub_host, arg );
+			} else {
+				deepCopy( sub_host, sub_target, arg );
+			}
 		} else {
-			printd( "DualViewMap::copyToHost, target==host, skipping...\n");
+			printd( "DualViewMap::copyRange, target==host, skipping...\n");
 			assert( this->view_target().data() == this->view_host().data() );
-			assert( this-> map_target().data() == this-> map_host().data() );
 		}
 	}
 };
@@ -282,8 +1142,15 @@ public:
 template<typename T>
 struct is_DualViewMap : std::false_type {};
 
-template<typename EigenType, Target targetArg>
-struct is_DualViewMap<DualViewMap<EigenType, targetArg>> : std::true_type {};
+template<
+	typename EigenType, Target targetArg,
+	LayoutPolicy layoutPolicy, HostMemoryPolicy hostMemory, typename Scalar_target
+>
+struct is_DualViewMap<
+	DualViewMap<EigenType, targetArg, layoutPolicy, hostMemory, Scalar_target>
+> :
+	std::true_type
+{};
 
 template<typename T>
 inline constexpr bool is_DualViewMap_v = is_DualViewMap<T>::value;
@@ -299,6 +1166,21 @@ dualViewMap(
 	return {eigenObj, copyToTarget};
 }
 
+/* Like dualViewMap<target>(eigenObj), but with a different scalar type
+ * on the target, e.g. dualViewMap<target, float>(doubleArray) */
+template<Target target, typename Scalar_target, typename EigenType>
+std::enable_if_t<is_eigen_dense<remove_qualifiers<EigenType>>,
+	DualViewMap<EigenType, target,
+		LayoutPolicy::aos, HostMemoryPolicy::pageable, Scalar_target
+	>
+>
+dualViewMap(
+	EigenType& eigenObj,
+	DualViewCopyOnInit copyToTarget = CopyToTarget
+){
+	return {eigenObj, copyToTarget};
+}
+
 #define KOKKIDIO_DUALMAPVIEW_FACTORY \
 template<typename EigenType, Target target = DefaultTarget> \
 DualViewMap<EigenType, target> dualViewMap
@@ -0,0 +1,409 @@
+#ifndef KOKKIDIO_DUALVIEWMAPGROUP_HPP
+#define KOKKIDIO_DUALVIEWMAPGROUP_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/DualViewMap.hpp"
+
+#include <array>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief A fixed set of DualViewMaps, one for each of @a EigenTypes,
+ * whose target sides share a single allocation.
+ * All members are transferred with a single copy per direction,
+ * which saves the latency of one transfer per member,
+ * e.g. for kernels with many inputs.
+ * Each member is a regular DualViewMap<EigenType, target>,
+ * accessed via get<I>(), whose map_target() etc. can be used as usual.
+ *
+ * When created from Eigen objects, their data is packed into
+ * (and unpacked from) a staging buffer on the host,
+ * in page-locked memory if available.
+ * When created from sizes, the host sides share an allocation as well,
+ * so that no packing is needed.
+ *
+ * Const members are only copied to the target,
+ * and copyToHost() only transfers the byte range spanned by non-const members.
+ * Members must not be resized beyond their size,
+ * because they would then move out of the shared allocation.
+ *
+ * @tparam targetArg
+ * @tparam EigenTypes: contiguous Eigen types, may be const.
+ */
+template<Target targetArg, typename... EigenTypes>
+class DualViewMapGroup {
+public:
+	static constexpr Target target { ExecutionTarget<targetArg> };
+	static constexpr std::size_t nMembers { sizeof...(EigenTypes) };
+	/* Byte alignment of each member within the shared allocations */
+	static constexpr std::size_t alignment {128};
+
+	using Members = std::tuple<DualViewMap<EigenTypes, target>...>;
+	template<std::size_t I>
+	using Member = std::tuple_element_t<I, Members>;
+
+	using ExecutionSpace_target = ExecutionSpace<target>;
+	using Dims = std::array<Index, 2>;
+
+	static_assert( nMembers > 0 );
+	static_assert( ( is_contiguous<EigenTypes>() && ... ),
+		"DualViewMapGroup requires contiguous Eigen types."
+	);
+
+protected:
+	using BlockType_host   = typename CachingAllocator<MemorySpace<Target::host>>::BlockType;
+	using BlockType_target = typename CachingAllocator<MemorySpace<target>>::BlockType;
+	using StagingType = Kokkos::View<std::byte*,
+		MemorySpace<Target::host, HostMemoryPolicy::pinned>
+	>;
+
+	Members m_members;
+	std::array<std::size_t, nMembers> m_offsets {}, m_bytes {};
+	std::size_t m_totalBytes {0};
+	BlockType_host   m_block_host;
+	BlockType_target m_block_target;
+	/* Only allocated when the host sides wrap Eigen objects */
+	StagingType m_staging;
+	/* Instance of the last transfer, which used the staging buffer */
+	ExecutionSpace_target m_space;
+
+	static constexpr auto indices { std::make_index_sequence<nMembers>{} };
+
+	template<std::size_t I>
+	using EigenType_member = std::tuple_element_t<I, std::tuple<EigenTypes...>>;
+
+	template<typename T>
+	static constexpr bool isWritable { !std::is_const_v<T> };
+
+public:
+	/**
+	 * @brief Creates the members from existing Eigen objects,
+	 * whose data is copied to the target, unless DontCopyToTarget is passed.
+	 */
+	DualViewMapGroup(
+		EigenTypes&... hostObjs,
+		DualViewCopyOnInit copyToTarget = CopyToTarget
+	){
+		this->setOffsets( Dims{ hostObjs.rows(), hostObjs.cols() }... );
+		if constexpr ( target != Target::host ){
+			this->m_block_target = this->allocBlock<BlockType_target>(
+				"Kokkidio::DualViewMapGroup::block_target"
+			);
+			this->m_staging = this->allocBlock<StagingType>(
+				"Kokkidio::DualViewMapGroup::staging"
+			);
+		}
+		this->wrapMembers( indices, hostObjs... );
+		if ( copyToTarget ){
+			this->copyToTarget();
+		}
+	}
+
+	/**
+	 * @brief Allocates the members with the sizes {rows, cols} in @a dims,
+	 * on both host and target, e.g.
+	 * DualViewMapGroup<target, ArrayXXs, ArrayXs> group { {3, n}, {n, 1} };
+	 */
+	DualViewMapGroup( std::initializer_list<Dims> dims ){
+		assert( dims.size() == nMembers );
+		std::array<Dims, nMembers> dimsArr;
+		std::copy( dims.begin(), dims.end(), dimsArr.begin() );
+		std::apply( [&](const auto&... d){ this->setOffsets(d...); }, dimsArr );
+		this->m_block_host = this->allocBlock<BlockType_host>(
+			"Kokkidio::DualViewMapGroup::block_host"
+		);
+		if constexpr ( target != Target::host ){
+			this->m_block_target = this->allocBlock<BlockType_target>(
+				"Kokkidio::DualViewMapGroup::block_target"
+			);
+		}
+		forEachMember( [&](auto i){ this->allocMember<i>( dimsArr[i] ); } );
+	}
+
+	template<std::size_t I>
+	auto get() -> Member<I>& {
+		return std::get<I>(this->m_members);
+	}
+
+	template<std::size_t I>
+	auto get() const -> const Member<I>& {
+		return std::get<I>(this->m_members);
+	}
+
+	auto members() -> Members& {
+		return this->m_members;
+	}
+
+	auto members() const -> const Members& {
+		return this->m_members;
+	}
+
+	/* Size of the shared target allocation, including alignment padding */
+	std::size_t bytes() const {
+		return this->m_totalBytes;
+	}
+
+	/* See DualViewMap::copyToTarget and DualViewMap::copyToHost */
+	void copyToTarget(bool async = false){
+		this->transfer<true>(async);
+	}
+
+	void copyToHost(bool async = false){
+		this->transfer<false>(async);
+	}
+
+	auto copyToTarget(const ExecutionSpace_target& space)
+		-> TransferHandle<ExecutionSpace_target>
+	{
+		this->transfer<true>(space);
+		return {space};
+	}
+
+	/* When the host sides wrap Eigen objects,
+	 * the data must be unpacked on the host, so this waits for the copy. */
+	auto copyToHost(const ExecutionSpace_target& space)
+		-> TransferHandle<ExecutionSpace_target>
+	{
+		this->transfer<false>(space);
+		return {space};
+	}
+
+protected:
+	static std::size_t alignUp( std::size_t bytes ){
+		return (bytes + alignment - 1) / alignment * alignment;
+	}
+
+	template<typename... DimsArgs>
+	void setOffsets( const DimsArgs&... dims ){
+		std::size_t i {0}, offset {0};
+		auto add = [&](const Dims& d, std::size_t scalarSize){
+			this->m_offsets[i] = offset;
+			this->m_bytes  [i] = scalarSize * static_cast<std::size_t>( d[0] * d[1] );
+			offset += alignUp( this->m_bytes[i] );
+			++i;
+		};
+		( add( this->adjustDims<EigenTypes>(dims),
+			sizeof( typename std::remove_const_t<EigenTypes>::Scalar )
+		), ... );
+		this->m_totalBytes = offset;
+	}
+
+	template<typename EigenType>
+	static Dims adjustDims( Dims d ){
+		using P = std::remove_const_t<EigenType>;
+		if constexpr ( P::RowsAtCompileTime != Eigen::Dynamic ){
+			d[0] = P::RowsAtCompileTime;
+		}
+		if constexpr ( P::ColsAtCompileTime != Eigen::Dynamic ){
+			d[1] = P::ColsAtCompileTime;
+		}
+		return d;
+	}
+
+	template<typename Block>
+	auto allocBlock( const char* label ) const -> Block {
+		return Block{
+			Kokkos::view_alloc(
+				typename Block::memory_space{}, Kokkos::WithoutInitializing, label
+			),
+			this->m_totalBytes
+		};
+	}
+
+	template<std::size_t I, typename Block>
+	auto subBlock( const Block& block ) const -> Block {
+		return Kokkos::subview( block, std::make_pair(
+			this->m_offsets[I], this->m_offsets[I] + this->m_bytes[I]
+		) );
+	}
+
+	template<std::size_t I, typename Block>
+	auto dataPtr( const Block& block ) const {
+		using Scalar = typename std::remove_const_t<EigenType_member<I>>::Scalar;
+		return reinterpret_cast<Scalar*>( block.data() + this->m_offsets[I] );
+	}
+
+	/* Calls func(std::integral_constant<std::size_t, I>) for each member */
+	template<typename Func>
+	static void forEachMember( Func&& func ){
+		forEachMember( std::forward<Func>(func), indices );
+	}
+
+	template<typename Func, std::size_t... I>
+	static void forEachMember( Func&& func, std::index_sequence<I...> ){
+		( func( std::integral_constant<std::size_t, I>{} ), ... );
+	}
+
+	template<std::size_t... I>
+	void wrapMembers( std::index_sequence<I...>, EigenTypes&... hostObjs ){
+		( this->wrapMember<I>(hostObjs), ... );
+	}
+
+
+	template<std::size_t I, typename EigenType>
+	void wrapMember( EigenType& hostObj ){
+		using M = Member<I>;
+		if constexpr ( target == Target::host ){
+			std::get<I>(this->m_members) = M{ hostObj, DontCopyToTarget };
+		} else {
+			std::get<I>(this->m_members) = M{
+				typename M::ViewMap_host{ hostObj },
+				typename M::ViewMap_target{
+					this->subBlock<I>(this->m_block_target),
+					hostObj.rows(), hostObj.cols()
+				}
+			};
+		}
+	}
+
+	template<std::size_t I>
+	void allocMember( const Dims& dims ){
+		using M = Member<I>;
+		typename M::ViewMap_host hostSide {
+			this->subBlock<I>(this->m_block_host), dims[0], dims[1]
+		};
+		if constexpr ( target == Target::host ){
+			std::get<I>(this->m_members) = M{ hostSide, hostSide };
+		} else {
+			std::get<I>(this->m_members) = M{
+				hostSide,
+				typename M::ViewMap_target{
+					this->subBlock<I>(this->m_block_target), dims[0], dims[1]
+				}
+			};
+		}
+	}
+
+	/* Byte range spanned by all members which are copied in this direction */
+	template<bool toTarget>
+	auto transferRange() const -> std::pair<std::size_t, std::size_t> {
+		if constexpr (toTarget){
+			return {0, this->m_totalBytes};
+		} else {
+			std::size_t begin {this->m_totalBytes}, end {0}, i {0};
+			auto add = [&](bool writable){
+				if (writable){
+					begin = std::min( begin, this->m_offsets[i] );
+					end   = std::max( end, this->m_offsets[i] + this->m_bytes[i] );
+				}
+				++i;
+			};
+			( add( isWritable<EigenTypes> ), ... );
+			return { begin, std::max(begin, end) };
+		}
+	}
+
+	template<typename Dst, typename Src, typename CopyArg>
+	static void copyBytes( const Dst& dst, const Src& src, const CopyArg& arg ){
+		if constexpr ( std::is_same_v<CopyArg, bool> ){
+			if (arg){
+				Kokkos::deep_copy( ExecutionSpace_target{}, dst, src );
+			} else {
+				Kokkos::deep_copy( dst, src );
+			}
+		} else {
+			Kokkos::deep_copy( arg, dst, src );
+		}
+	}
+
+	template<bool toTarget, typename CopyArg>
+	void transfer( [[maybe_unused]] const CopyArg& arg ){
+		if constexpr ( target != Target::host ){
+			auto [begin, end] { this->transferRange<toTarget>() };
+			auto range { std::make_pair(begin, end) };
+			auto sub = [&](const auto& block){
+				return Kokkos::subview(block, range);
+			};
+			if ( begin < end ){
+				printd( "DualViewMapGroup: copying %lu bytes to %s...\n"
+					, end - begin
+					, toTarget ? "target" : "host"
+				);
+				if ( this->m_staging.is_allocated() ){
+					/* the staging buffer may still be in use by the last transfer */
+					this->m_space.fence("Kokkidio::DualViewMapGroup::transfer");
+					if constexpr ( std::is_same_v<CopyArg, bool> ){
+						this->m_space = ExecutionSpace_target{};
+					} else {
+						this->m_space = arg;
+					}
+					if constexpr (toTarget){
+						forEachMember( [&](auto i){ this->packMember<i>(); } );
+						copyBytes( sub(this->m_block_target), sub(this->m_staging), arg );
+					} else {
+						copyBytes( sub(this->m_staging), sub(this->m_block_target), arg );
+						this->m_space.fence("Kokkidio::DualViewMapGroup::transfer");
+						forEachMember( [&](auto i){ this->unpackMember<i>(); } );
+					}
+				} else if constexpr (toTarget){
+					copyBytes( sub(this->m_block_target), sub(this->m_block_host), arg );
+				} else {
+					copyBytes( sub(this->m_block_host), sub(this->m_block_target), arg );
+				}
+			}
+		}
+		/* both sides are in sync for all members which were copied */
+		forEachMember( [&](auto i){
+			if constexpr ( toTarget || isWritable<EigenType_member<i>> ){
+				std::get<i>(this->m_members).clearSyncState();
+			}
+		} );
+	}
+
+	template<std::size_t I>
+	auto stagingMap() const {
+		using P = std::remove_const_t<
+			typename detail::MapTraits<EigenType_member<I>>::PlainObjectType
+		>;
+		const Member<I>& m { std::get<I>(this->m_members) };
+		return Eigen::Map<P>( this->dataPtr<I>(this->m_staging), m.rows(), m.cols() );
+	}
+
+	template<std::size_t I>
+	void packMember() const {
+		this->stagingMap<I>() = std::get<I>(this->m_members).map_host();
+	}
+
+	template<std::size_t I>
+	void unpackMember() const {
+		if constexpr ( isWritable<EigenType_member<I>> ){
+			std::get<I>(this->m_members).map_host() = this->stagingMap<I>();
+		}
+	}
+};
+
+/* Shorthand for group.template get<I>() in templated code */
+template<std::size_t I, Target target, typename... EigenTypes>
+auto get( DualViewMapGroup<target, EigenTypes...>& group )
+	-> typename DualViewMapGroup<target, EigenTypes...>::template Member<I>&
+{
+	return group.template get<I>();
+}
+
+template<std::size_t I, Target target, typename... EigenTypes>
+auto get( const DualViewMapGroup<target, EigenTypes...>& group )
+	-> const typename DualViewMapGroup<target, EigenTypes...>::template Member<I>&
+{
+	return group.template get<I>();
+}
+
+template<typename T>
+struct is_DualViewMapGroup : std::false_type {};
+
+template<Target target, typename... EigenTypes>
+struct is_DualViewMapGroup<DualViewMapGroup<target, EigenTypes...>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_DualViewMapGroup_v = is_DualViewMapGroup<T>::value;
+
+} // namespace Kokkidio
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "Kokkidio/ViewMap.hpp"
 #include "Kokkidio/DualViewMap.hpp"
+#include "Kokkidio/FixedViewMap.hpp"
 #include "Kokkidio/ompSegment.hpp"
 #include "Kokkidio/typeHelpers.hpp"
 #include "Kokkidio/typeAliases.hpp"
@@ -68,13 +69,35 @@ KOKKIDIO_INL_AUTO autoRange( const Rng& rng, EigenObj&& obj ){
 	}
 }
 
+/* Block of @a obj at the rows in @a rowRng and the columns in @a colRng,
+ * which are either both an IndexRange, or both a single index.
+ * Single indices also yield a (1x1) block,
+ * so that the expression type is the same on all targets. */
+template<typename EigenObj, typename Rng>
+KOKKIDIO_INL_AUTO blockRange( const Rng& rowRng, const Rng& colRng, EigenObj&& obj ){
+	using URng = remove_qualifiers<Rng>;
+	using UObj = remove_qualifiers<EigenObj>;
+	static_assert(std::is_base_of_v<Eigen::DenseBase<UObj>, UObj>);
+	if constexpr ( std::is_integral_v<URng> ){
+		assert( obj.rows() > rowRng && obj.cols() > colRng );
+		return obj.block( rowRng, colRng, 1, 1 );
+	} else {
+		static_assert( is_IndexRange_v<Rng> );
+		assert( obj.rows() >= rowRng.start() + rowRng.size() );
+		assert( obj.cols() >= colRng.start() + colRng.size() );
+		return obj.block(
+			rowRng.start(), colRng.start(), rowRng.size(), colRng.size()
+		);
+	}
+}
+
 template<typename T>
 KOKKIDIO_INL_AUTO eigenObj( T&& t ){
 	using U = remove_qualifiers<T>;
 	if constexpr (std::is_base_of_v<Eigen::DenseBase<U>, U>){
 		return t;
 	} else
-	if constexpr ( is_ViewMap_v<U> ){
+	if constexpr ( is_ViewMap_v<U> || is_FixedViewMap_v<U> ){
 		return t.map();
 	} else
 	if constexpr ( is_DualViewMap_v<U> ){
@@ -82,12 +105,51 @@ KOKKIDIO_INL_AUTO eigenObj( T&& t ){
 	}
 }
 
+/* Whether T is a ViewMap (or DualViewMap) with padded columns,
+ * whose column ranges are mapped with ViewMap::map_cols */
+template<typename T>
+KOKKOS_FUNCTION constexpr bool hasPaddedCols(){
+	using U = remove_qualifiers<T>;
+	if constexpr ( is_ViewMap_v<U> ){
+		return U::IsPadded && !U::IsRowMajor;
+	} else
+	if constexpr ( is_DualViewMap_v<U> ){
+		return hasPaddedCols<typename U::ViewMap_target>();
+	} else {
+		return false;
+	}
+}
+
+template<typename T>
+KOKKIDIO_INL_AUTO paddedViewMap( T&& t ){
+	using U = remove_qualifiers<T>;
+	if constexpr ( is_ViewMap_v<U> ){
+		return t;
+	} else {
+		return t.get_target();
+	}
+}
+
+template<typename ViewMapType, typename Rng>
+KOKKIDIO_INL_AUTO paddedColRange( const Rng& rng, const ViewMapType& vm ){
+	if constexpr ( std::is_integral_v<remove_qualifiers<Rng>> ){
+		return vm.map_col(rng);
+	} else {
+		static_assert( is_IndexRange_v<Rng> );
+		return vm.map_cols( rng.start(), rng.size() );
+	}
+}
+
 } // namespace detail
 
 
 template<typename EigenObj, typename Rng>
 KOKKIDIO_INL_AUTO colRange( const Rng& rng, EigenObj&& obj ){
-	return detail::colRange( rng, detail::eigenObj(obj) );
+	if constexpr ( detail::hasPaddedCols<EigenObj>() ){
+		return detail::paddedColRange( rng, detail::paddedViewMap(obj) );
+	} else {
+		return detail::colRange( rng, detail::eigenObj(obj) );
+	}
 }
 
 template<typename EigenObj, typename Rng>
@@ -97,7 +159,19 @@ KOKKIDIO_INL_AUTO rowRange( const Rng& rng, EigenObj&& obj ){
 
 template<typename EigenObj, typename Rng>
 KOKKIDIO_INL_AUTO autoRange( const Rng& rng, EigenObj&& obj ){
-	return detail::autoRange( rng, detail::eigenObj(obj) );
+	using Map = remove_qualifiers<decltype( detail::eigenObj(obj) )>;
+	if constexpr (
+		detail::hasPaddedCols<EigenObj>() && Map::ColsAtCompileTime != 1
+	){
+		return colRange( rng, std::forward<EigenObj>(obj) );
+	} else {
+		return detail::autoRange( rng, detail::eigenObj(obj) );
+	}
+}
+
+template<typename EigenObj, typename Rng>
+KOKKIDIO_INL_AUTO blockRange( const Rng& rowRng, const Rng& colRng, EigenObj&& obj ){
+	return detail::blockRange( rowRng, colRng, detail::eigenObj(obj) );
 }
 
 
@@ -6,6 +6,7 @@
 #endif
 
 #include "Kokkidio/typeAliases.hpp"
+#include "Kokkidio/typeHelpers.hpp"
 
 namespace Kokkidio
 {
@@ -61,15 +62,96 @@ inline constexpr bool is_eigen_map_v = is_eigen_map<T>::value;
 
 
 
+namespace detail
+{
+
+/* Splits an Eigen type into the plain object type that is mapped,
+ * and the alignment options and stride type
+ * of the Eigen::Map which accesses it. */
+template<typename EigenType>
+struct MapTraits {
+	using PlainObjectType = EigenType;
+	static constexpr int MapOptions {Eigen::Unaligned};
+	using StrideType = Eigen::Stride<0, 0>;
+};
+
+template<typename _PlainObjectType, int mapOptions, typename _StrideType>
+struct MapTraits<Eigen::Map<_PlainObjectType, mapOptions, _StrideType>> {
+	using PlainObjectType = _PlainObjectType;
+	static constexpr int MapOptions {mapOptions};
+	using StrideType = _StrideType;
+};
+
+template<typename EigenType>
+struct MapTraits<const EigenType> {
+	using PlainObjectType = const typename MapTraits<EigenType>::PlainObjectType;
+	static constexpr int MapOptions { MapTraits<EigenType>::MapOptions };
+	using StrideType = typename MapTraits<EigenType>::StrideType;
+};
+
+/* The same Eigen type, but with a different scalar type */
+template<typename EigenType, typename Scalar>
+struct WithScalar {
+	static_assert( dependent_false<EigenType>::value,
+		"Only Eigen::Matrix, Eigen::Array, and Eigen::Maps of them "
+		"can change their scalar type."
+	);
+};
+
+template<typename _Scalar, int ... opts, typename Scalar>
+struct WithScalar<Eigen::Matrix<_Scalar, opts ...>, Scalar> {
+	using Type = Eigen::Matrix<Scalar, opts ...>;
+};
+
+template<typename _Scalar, int ... opts, typename Scalar>
+struct WithScalar<Eigen::Array<_Scalar, opts ...>, Scalar> {
+	using Type = Eigen::Array<Scalar, opts ...>;
+};
+
+template<typename PlainObjectType, int mapOptions, typename StrideType, typename Scalar>
+struct WithScalar<Eigen::Map<PlainObjectType, mapOptions, StrideType>, Scalar> {
+	using Type = Eigen::Map<
+		typename WithScalar<PlainObjectType, Scalar>::Type, mapOptions, StrideType
+	>;
+};
+
+template<typename EigenType, typename Scalar>
+struct WithScalar<const EigenType, Scalar> {
+	using Type = const typename WithScalar<EigenType, Scalar>::Type;
+};
+
+} // namespace detail
+
+/* e.g. with_scalar_t<const ArrayXXd, float> is const ArrayXXf */
+template<typename EigenType, typename Scalar>
+using with_scalar_t = typename detail::WithScalar<EigenType, Scalar>::Type;
+
+/* true for Eigen::Maps with an outer stride, e.g. Eigen::OuterStride<> */
+template<typename EigenType>
+inline constexpr bool has_outer_stride_v {
+	detail::MapTraits<EigenType>::StrideType::OuterStrideAtCompileTime != 0
+};
+
+
+template <typename _Derived>
+constexpr bool has_unit_inner_stride() {
+	using Derived = std::remove_const_t<_Derived>;
+	static_assert( std::is_base_of_v<Eigen::DenseBase<Derived>, Derived> );
+	return Eigen::internal::traits<Derived>::InnerStrideAtCompileTime == 1;
+}
+
 template <typename _Derived>
 constexpr bool is_contiguous() {
 	using Derived = std::remove_const_t<_Derived>;
 	static_assert( std::is_base_of_v<Eigen::DenseBase<Derived>, Derived> );
 	using T = Eigen::internal::traits<Derived>;
 	return
-		Eigen::internal::traits<Derived>::InnerStrideAtCompileTime == 1 &&
+		has_unit_inner_stride<Derived>() &&
 		// (Derived::Flags & Eigen::LinearAccessBit);
-		T::OuterStrideAtCompileTime == T::RowsAtCompileTime;
+		T::OuterStrideAtCompileTime == ( Derived::IsRowMajor ?
+			T::ColsAtCompileTime :
+			T::RowsAtCompileTime
+		);
 }
 
 
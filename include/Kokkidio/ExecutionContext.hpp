@@ -0,0 +1,274 @@
+#ifndef KOKKIDIO_EXECUTIONCONTEXT_HPP
+#define KOKKIDIO_EXECUTIONCONTEXT_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/parallel_for.hpp"
+#include "Kokkidio/parallel_reduce.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace Kokkidio
+{
+
+namespace detail
+{
+
+/* Whether an ExecutionContext on @a target keeps one OpenMP parallel region
+ * alive across its dispatches. Otherwise, it forwards each dispatch
+ * to the free functions, e.g. on the device, or with the ThreadPool,
+ * which doesn't fork and join per dispatch anyway. */
+#if !defined(KOKKIDIO_OPENMP) || defined(KOKKIDIO_HOST_THREADPOOL) || \
+	( defined(KOKKIDIO_USE_SYCL) && !defined(KOKKIDIO_SYCL_DISABLE_ON_HOST) )
+template<Target target>
+inline constexpr bool is_context_region {false};
+#else
+template<Target target>
+inline constexpr bool is_context_region { target == Target::host };
+#endif
+
+/* Holds the partial results of reductions inside one parallel region,
+ * one slot per thread, each on its own cache line. */
+class ContextShared {
+public:
+	struct alignas(64) Slot {
+		unsigned char bytes[64];
+	};
+
+protected:
+	std::vector<Slot> m_slots;
+
+public:
+	ContextShared() = default;
+
+	explicit ContextShared(int nThreads) :
+		m_slots( static_cast<std::size_t>(nThreads) )
+	{}
+
+	template<typename Scalar>
+	void store( int thread, const Scalar& value ){
+		static_assert( sizeof(Scalar) <= sizeof(Slot) );
+		static_assert( std::is_trivially_copyable_v<Scalar> );
+		std::memcpy( this->m_slots[thread].bytes, &value, sizeof(Scalar) );
+	}
+
+	template<typename Scalar>
+	Scalar load( int thread ) const {
+		Scalar value;
+		std::memcpy( &value, this->m_slots[thread].bytes, sizeof(Scalar) );
+		return value;
+	}
+};
+
+} // namespace detail
+
+
+/**
+ * @brief Dispatches a sequence of kernels without re-creating
+ * the parallel region for each of them, see executionContext.
+ *
+ * On the host with OpenMP, every thread of the region
+ * calls each member function, which processes the thread's segment
+ * (the same as ParallelRange<Target::host>),
+ * followed by a barrier, so that the next dispatch sees all results.
+ * Otherwise, the member functions forward to the free functions
+ * of the same name, e.g. Kokkidio::parallel_for<target>.
+ */
+template<Target _target = DefaultTarget>
+class ExecutionContext {
+public:
+	static constexpr Target target {_target};
+	static constexpr bool isRegion { detail::is_context_region<target> };
+
+protected:
+	detail::ContextShared* m_shared {nullptr};
+
+	template<Target, typename Func>
+	friend void executionContext(Func&&);
+
+	ExecutionContext() = default;
+
+	explicit ExecutionContext(detail::ContextShared& shared) :
+		m_shared {&shared}
+	{}
+
+	template<typename Policy, typename Func, typename Scalar>
+	static void reduceSegment( const Policy& pol, Func&& func, Scalar& var ){
+		if constexpr ( detail::is_range_invocable_redux<Func, Scalar&> ){
+			func( ParallelRange<Target::host>{pol}, var );
+		} else {
+			auto seg { ompSegment(pol) };
+			for (int i = seg.start(); i < seg.end(); ++i){
+				func(i, var);
+			}
+		}
+	}
+
+	/* Combines the threads' partial results,
+	 * and writes the total to the reducer on every thread */
+	template<typename Reducer>
+	void joinPartials(
+		const Reducer& reducer, const typename Reducer::value_type& partial
+	) const {
+		using Scalar = typename Reducer::value_type;
+		const int p { detail::host::threadNum() };
+		this->m_shared->store(p, partial);
+		this->barrier();
+		Scalar total;
+		reducer.init(total);
+		for (int i {0}; i < detail::schedule::numThreads(); ++i){
+			reducer.join( total, this->m_shared->template load<Scalar>(i) );
+		}
+		reducer.reference() = total;
+		/* no thread may overwrite its slot before all threads have read it */
+		this->barrier();
+	}
+
+public:
+	/**
+	 * @brief Waits for all threads of the context.
+	 * Every dispatch already ends with a barrier,
+	 * so this is only needed around code outside of dispatches.
+	 */
+	void barrier() const {
+		if constexpr (isRegion){
+			KOKKIDIO_OMP_PRAGMA(barrier)
+		}
+	}
+
+	/**
+	 * @brief Calls @a func on a single thread, while the others wait.
+	 */
+	template<typename Func>
+	void single( Func&& func ) const {
+		if constexpr (isRegion){
+			KOKKIDIO_OMP_PRAGMA(single)
+			{
+				func();
+			}
+		} else {
+			func();
+		}
+	}
+
+	template<typename Policy, typename Func>
+	void parallel_for_range( const Policy& pol, Func&& func ) const {
+		if constexpr (isRegion){
+			func( ParallelRange<target>{pol} );
+			this->barrier();
+		} else {
+			Kokkidio::parallel_for_range<target>( pol, std::forward<Func>(func) );
+		}
+	}
+
+	template<typename Policy, typename Func>
+	void parallel_for( const Policy& pol, Func&& func ) const {
+		if constexpr (isRegion){
+			if constexpr ( detail::is_range_invocable<Func> ){
+				func( ParallelRange<target>{pol} );
+			} else {
+				auto seg { ompSegment(pol) };
+				for (int i = seg.start(); i < seg.end(); ++i){
+					func(i);
+				}
+			}
+			this->barrier();
+		} else {
+			Kokkidio::parallel_for<target>( pol, std::forward<Func>(func) );
+		}
+	}
+
+	template<typename Policy, typename Func>
+	void parallel_for_chunks( const Policy& pol, Func&& func ) const {
+		if constexpr (isRegion){
+			ParallelRange<target>{pol}.for_each_chunk( std::forward<Func>(func) );
+			this->barrier();
+		} else {
+			Kokkidio::parallel_for_chunks<target>( pol, std::forward<Func>(func) );
+		}
+	}
+
+	/**
+	 * @brief Same as Kokkidio::parallel_reduce.
+	 * On the host, the result is written on every thread,
+	 * so @a reducer should refer to a variable declared
+	 * inside the function passed to executionContext,
+	 * of which each thread has its own copy.
+	 */
+	template<typename Policy, typename Func, typename Reducer>
+	void parallel_reduce( const Policy& pol, Func&& func, const Reducer& reducer ) const {
+		if constexpr (isRegion){
+			typename Reducer::value_type var;
+			reducer.init(var);
+			reduceSegment( pol, func, var );
+			this->joinPartials(reducer, var);
+		} else {
+			Kokkidio::parallel_reduce<target>( pol, std::forward<Func>(func), reducer );
+		}
+	}
+
+	/**
+	 * @brief Same as Kokkidio::parallel_reduce_chunks,
+	 * see parallel_reduce for where the result is written.
+	 */
+	template<typename Policy, typename Func, typename Reducer>
+	void parallel_reduce_chunks( const Policy& pol, Func&& func, const Reducer& reducer ) const {
+		if constexpr (isRegion){
+			using Scalar = typename Reducer::value_type;
+			Scalar var;
+			reducer.init(var);
+			ParallelRange<target>{pol}.for_each_chunk( [&](const Chunk<target>& chunk){
+				func(chunk, var);
+			});
+			this->joinPartials(reducer, var);
+		} else {
+			Kokkidio::parallel_reduce_chunks<target>( pol, std::forward<Func>(func), reducer );
+		}
+	}
+};
+
+
+/**
+ * @brief Calls @a func with an ExecutionContext<target>,
+ * through which several kernels can be dispatched in sequence,
+ * e.g.
+ * auto kernel = KOKKOS_LAMBDA(Chunk<target> chunk){ ... };
+ * executionContext<target>( [&](ExecutionContext<target>& ctx){
+ * 	for (int iter = 0; iter < nRuns; ++iter){
+ * 		ctx.parallel_for_chunks(nCols, kernel);
+ * 	}
+ * });
+ * Kernels are defined outside of @a func,
+ * because nvcc does not allow extended lambdas inside other lambdas.
+ *
+ * On the host with OpenMP, this creates a single parallel region,
+ * in which every thread calls @a func,
+ * so variables declared inside @a func exist once per thread,
+ * and the fork/join cost is only paid once, instead of once per dispatch.
+ * Buffers (makeBuffer) and ViewMaps must therefore be created outside,
+ * and only the dispatches of @a ctx may be used inside,
+ * which must be reached by all threads in the same order.
+ * Elsewhere, @a func is called once, on the calling thread.
+ */
+template<Target target = DefaultTarget, typename Func>
+void executionContext( Func&& func ){
+	static_assert( std::is_invocable_v<Func, ExecutionContext<target>&> );
+	if constexpr ( ExecutionContext<target>::isRegion ){
+		detail::ContextShared shared { detail::host::maxThreads() };
+		KOKKIDIO_OMP_PRAGMA(parallel)
+		{
+			ExecutionContext<target> ctx {shared};
+			func(ctx);
+		}
+	} else {
+		ExecutionContext<target> ctx;
+		func(ctx);
+	}
+}
+
+} // namespace Kokkidio
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef KOKKIDIO_FIXEDVIEWMAP_HPP
+#define KOKKIDIO_FIXEDVIEWMAP_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/typeAliases.hpp"
+#include "Kokkidio/EigenTypeHelpers.hpp"
+#include "Kokkidio/syclify_macros.hpp"
+
+#include <Kokkos_Core.hpp>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Lightweight counterpart to ViewMap for small fixed-size Eigen types,
+ * e.g. a table of coefficients or stencil weights used inside a kernel.
+ *
+ * The data is stored inside the object instead of a Kokkos::View,
+ * so FixedViewMap is trivially copyable, and a KOKKOS_LAMBDA
+ * captures the values themselves, without reference counting.
+ * map() returns an Eigen::Map with compile-time extents.
+ *
+ * Unlike ViewMap, FixedViewMap has value semantics:
+ * every copy, including the one captured by a kernel, holds its own data.
+ * Therefore, no target is needed, but writes inside a kernel
+ * are not visible outside of it.
+ * The size is limited to maxBytes, to keep kernel arguments small.
+ */
+template<typename _EigenType>
+class FixedViewMap {
+public:
+	using EigenType_host = _EigenType;
+	using PlainObjectType = std::remove_const_t<
+		typename detail::MapTraits<EigenType_host>::PlainObjectType
+	>;
+	using Scalar = typename PlainObjectType::Scalar;
+	using MapType = Eigen::Map<PlainObjectType, Eigen::Aligned16>;
+	using ConstMapType = Eigen::Map<const PlainObjectType, Eigen::Aligned16>;
+
+	static constexpr Index RowsAtCompileTime { PlainObjectType::RowsAtCompileTime };
+	static constexpr Index ColsAtCompileTime { PlainObjectType::ColsAtCompileTime };
+	static constexpr Index SizeAtCompileTime { PlainObjectType::SizeAtCompileTime };
+	static constexpr std::size_t maxBytes {1024};
+
+	static_assert( SizeAtCompileTime != Eigen::Dynamic,
+		"FixedViewMap requires a fixed-size Eigen type. Use ViewMap instead."
+	);
+	static_assert( SizeAtCompileTime * sizeof(Scalar) <= maxBytes,
+		"FixedViewMap is meant for small types. Use ViewMap instead."
+	);
+
+protected:
+	alignas(16) Scalar m_data[SizeAtCompileTime];
+
+public:
+	/* Like Eigen's fixed-size types, the data is left uninitialised. */
+	FixedViewMap() = default;
+
+	template<typename Derived>
+	FixedViewMap( const Eigen::DenseBase<Derived>& obj ){
+		static_assert( std::is_trivially_copyable_v<FixedViewMap> );
+		this->map() = obj;
+	}
+
+	template<typename Derived>
+	FixedViewMap& operator=( const Eigen::DenseBase<Derived>& obj ){
+		this->map() = obj;
+		return *this;
+	}
+
+	KOKKOS_FUNCTION
+	static constexpr Index rows(){ return RowsAtCompileTime; }
+
+	KOKKOS_FUNCTION
+	static constexpr Index cols(){ return ColsAtCompileTime; }
+
+	KOKKOS_FUNCTION
+	static constexpr Index size(){ return SizeAtCompileTime; }
+
+	KOKKOS_FUNCTION
+	Scalar* data(){ return this->m_data; }
+
+	KOKKOS_FUNCTION
+	const Scalar* data() const { return this->m_data; }
+
+	/* No allocation check is needed, the data is always there. */
+	KOKKOS_FUNCTION
+	MapType map(){
+		return MapType{ this->m_data };
+	}
+
+	/* Copies captured by a KOKKOS_LAMBDA are const,
+	 * and therefore use this overload. */
+	KOKKOS_FUNCTION
+	ConstMapType map() const {
+		return ConstMapType{ this->m_data };
+	}
+};
+
+static_assert( std::is_trivially_copyable_v<FixedViewMap<ArrayNNs<3, 3>>> );
+
+template<typename T>
+struct is_FixedViewMap : std::false_type {};
+
+template<typename EigenType>
+struct is_FixedViewMap<FixedViewMap<EigenType>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_FixedViewMap_v = is_FixedViewMap<T>::value;
+
+template<typename Derived>
+FixedViewMap<typename Derived::PlainObject> fixedViewMap(
+	const Eigen::DenseBase<Derived>& obj
+){
+	return {obj};
+}
+
+} // namespace Kokkidio
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef KOKKIDIO_HOSTSCHEDULE_HPP
+#define KOKKIDIO_HOSTSCHEDULE_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/hostThreads.hpp"
+#include "Kokkidio/typeAliases.hpp"
+#include "Kokkidio/macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Selects how the host version of Kokkidio::parallel_for
+ * distributes its range among the OpenMP threads,
+ * e.g. parallel_for<Target::host>( HostSchedule{HostSchedule::dynamic, 16}, n, func ).
+ *
+ * segmented (the default) gives each thread one contiguous segment
+ * (see ompSegment), and calls the kernel once per thread.
+ *
+ * The other kinds split the range into pieces, which are handed out
+ * at runtime, and call the kernel once per piece,
+ * so that kernels with an uneven cost per index keep all threads busy:
+ * - dynamic pieces all have a size of chunkSize,
+ * - guided pieces start large, and shrink as the range is used up,
+ *   down to chunkSize,
+ * - with stealing, each thread first works through its own segment
+ *   in pieces of chunkSize, and then takes pieces
+ *   from the segments of other threads.
+ * A chunkSize of zero selects a default.
+ *
+ * Because the number of calls per thread varies,
+ * such kernels must not synchronise the threads, e.g. via "omp barrier".
+ * On the device, the schedule is ignored.
+ * With KOKKIDIO_HOST_THREADPOOL, every kind is balanced by the ThreadPool's
+ * work stealing, and segmented only sets one piece per worker.
+ */
+struct HostSchedule {
+	enum Kind {
+		segmented,
+		dynamic,
+		guided,
+		stealing,
+	};
+	Kind kind {segmented};
+	Index chunkSize {0};
+};
+
+namespace detail::schedule
+{
+
+inline int numThreads(){
+	#ifdef KOKKIDIO_OPENMP
+	return omp_get_num_threads();
+	#else
+	return 1;
+	#endif
+}
+
+using host::maxThreads;
+using host::threadNum;
+
+/* With dynamic and stealing, each thread gets about eight pieces,
+ * if no chunk size is set */
+inline Index pieceSize( const HostSchedule& sched, Index n ){
+	if ( sched.chunkSize > 0 ){
+		return sched.chunkSize;
+	}
+	if ( sched.kind == HostSchedule::guided ){
+		return 1;
+	}
+	return std::max<Index>( 1, n / ( 8 * maxThreads() ) );
+}
+
+/* The remaining part of one thread's segment, for HostSchedule::stealing.
+ * Each cursor has its own cache line, so that threads taking pieces
+ * from their own segment don't interfere with each other. */
+struct alignas(64) Cursor {
+	std::atomic<Index> next;
+	Index end;
+};
+
+/**
+ * @brief Opens a parallel region, in which @a func is called
+ * with each piece (an IndexRange<Index>) of @a range,
+ * as handed out according to @a sched.
+ * With HostSchedule::segmented, @a func is called once per thread,
+ * even if its segment is empty, otherwise only for non-empty pieces.
+ * With KOKKIDIO_HOST_THREADPOOL, the pieces run on the ThreadPool instead,
+ * and empty pieces are always skipped.
+ */
+template<typename Func>
+void forEachPiece(
+	const HostSchedule& sched, const IndexRange<Index>& range, const Func& func
+){
+	using S = HostSchedule;
+
+	#ifdef KOKKIDIO_HOST_THREADPOOL
+	/* The ThreadPool always balances its pieces via work stealing,
+	 * so the kind only decides on the piece size */
+	const Index n { range.size() };
+	if ( sched.kind == S::segmented ){
+		const Index nThreads { maxThreads() };
+		host::forEachPiece( range, (n + nThreads - 1) / nThreads, func );
+	} else {
+		host::forEachPiece( range,
+			sched.chunkSize > 0 ? sched.chunkSize : host::poolPieceSize(n), func
+		);
+	}
+	#else
+	const Index
+		end   { range.end() },
+		chunk { pieceSize( sched, range.size() ) };
+
+	if ( sched.kind == S::segmented ){
+		KOKKIDIO_OMP_PRAGMA(parallel)
+		{
+			func( ompSegment(range) );
+		}
+	} else
+	if ( sched.kind == S::dynamic || sched.kind == S::guided ){
+		std::atomic<Index> next { range.start() };
+		KOKKIDIO_OMP_PRAGMA(parallel)
+		{
+			const Index nThreads { numThreads() };
+			Index start { next.load(std::memory_order_relaxed) }, size;
+			while (true){
+				if ( sched.kind == S::dynamic ){
+					start = next.fetch_add(chunk, std::memory_order_relaxed);
+					size = std::min( chunk, end - start );
+				} else {
+					/* guided: half of an even share of the remaining range */
+					do {
+						size = std::min( end - start,
+							std::max( chunk, (end - start) / (2 * nThreads) )
+						);
+					} while ( start < end && !next.compare_exchange_weak(
+						start, start + size, std::memory_order_relaxed
+					) );
+				}
+				if ( start >= end ){
+					break;
+				}
+				func( IndexRange<Index>{start, size} );
+			}
+		}
+	} else
+	if ( sched.kind == S::stealing ){
+		std::vector<Cursor> cursors ( static_cast<std::size_t>( maxThreads() ) );
+		KOKKIDIO_OMP_PRAGMA(parallel)
+		{
+			const int
+				nThreads { numThreads() },
+				p { threadNum() };
+			auto seg { ompSegment(range) };
+			cursors[p].next.store( seg.start(), std::memory_order_relaxed );
+			cursors[p].end = seg.end();
+			KOKKIDIO_OMP_PRAGMA(barrier)
+			/* own segment first, then the following threads' segments */
+			for (int k {0}; k < nThreads; ++k){
+				Cursor& cursor { cursors[ (p + k) % nThreads ] };
+				Index start;
+				while ( ( start = cursor.next.fetch_add(
+					chunk, std::memory_order_relaxed
+				) ) < cursor.end ){
+					func( IndexRange<Index>{
+						start, std::min( chunk, cursor.end - start )
+					} );
+				}
+			}
+		}
+	}
+	#endif
+}
+
+} // namespace detail::schedule
+
+} // namespace Kokkidio
+
+#endif
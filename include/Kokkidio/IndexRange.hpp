@@ -47,7 +47,8 @@ template<typename Policy>
 IndexRange<detail::IndexType<Policy>>
 toIndexRange( const Policy& pol ){
 	if constexpr ( Kokkidio::is_RangePolicy_v<Policy> ){
-		return { pol.begin(), pol.end() };
+		/* a RangePolicy stores its end, not its size */
+		return { pol.begin(), pol.end(), LimitIsEnd{} };
 	} else {
 		static_assert(
 			std::is_integral_v<Policy> ||
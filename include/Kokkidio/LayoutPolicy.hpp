@@ -0,0 +1,99 @@
+#ifndef KOKKIDIO_LAYOUTPOLICY_HPP
+#define KOKKIDIO_LAYOUTPOLICY_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/EigenTypeHelpers.hpp"
+#include "Kokkidio/typeHelpers.hpp"
+
+namespace Kokkidio
+{
+
+/**
+ * @brief How the columns of a fixed-row type (e.g. ArrayNXs<3>) are stored.
+ *
+ * aos (array of structures) is Eigen's default column-major storage,
+ * where the entries of each column are adjacent.
+ *
+ * soa (structure of arrays) stores each row as one contiguous array,
+ * i.e. the type is stored row-major (Kokkos::LayoutRight).
+ * On a GPU, adjacent threads accessing adjacent columns
+ * then read adjacent memory, which allows coalesced memory access.
+ * Maps to such data are still regular Eigen expressions,
+ * so map().col(i) works for both.
+ *
+ * padded keeps the storage order, but pads the leading dimension
+ * (the number of rows for column-major types),
+ * so that every column starts on a 64-byte boundary, i.e. a cache line.
+ * The type becomes an Eigen::Map<..., Eigen::Aligned64, Eigen::OuterStride<>>,
+ * so that Eigen may use aligned packet loads,
+ * and the columns of different threads never share a cache line.
+ */
+enum class LayoutPolicy {
+	aos,
+	soa,
+	padded,
+};
+
+namespace detail
+{
+
+template<typename EigenType, LayoutPolicy policy>
+struct ApplyLayoutPolicy {
+	using Type = EigenType;
+};
+
+template<typename EigenType>
+struct ApplyLayoutPolicy<EigenType, LayoutPolicy::soa> {
+	using P = std::remove_const_t<EigenType>;
+	static_assert( is_owning_eigen_type_v<P>,
+		"LayoutPolicy::soa requires an Eigen::Matrix or Eigen::Array type."
+	);
+	static_assert( P::RowsAtCompileTime != Eigen::Dynamic,
+		"LayoutPolicy::soa requires a fixed number of rows."
+	);
+	/* Column vectors consist of a single row array anyway,
+	 * and Eigen does not allow them to be row-major. */
+	static constexpr int Options { P::ColsAtCompileTime == 1 ?
+		P::Options & ~Eigen::RowMajor :
+		P::Options |  Eigen::RowMajor
+	};
+	using Plain = std::conditional_t<is_eigen_matrix_v<P>,
+		Eigen::Matrix<typename P::Scalar,
+			P::RowsAtCompileTime, P::ColsAtCompileTime, Options,
+			P::MaxRowsAtCompileTime, P::MaxColsAtCompileTime
+		>,
+		Eigen::Array<typename P::Scalar,
+			P::RowsAtCompileTime, P::ColsAtCompileTime, Options,
+			P::MaxRowsAtCompileTime, P::MaxColsAtCompileTime
+		>
+	>;
+	using Type = transcribe_const_t<EigenType, Plain>;
+};
+
+template<typename EigenType>
+struct ApplyLayoutPolicy<EigenType, LayoutPolicy::padded> {
+	using P = std::remove_const_t<EigenType>;
+	static_assert( is_owning_eigen_type_v<P>,
+		"LayoutPolicy::padded requires an Eigen::Matrix or Eigen::Array type."
+	);
+	using Type = Eigen::Map<
+		transcribe_const_t<EigenType, P>, Eigen::Aligned64, Eigen::OuterStride<>
+	>;
+};
+
+} // namespace detail
+
+/**
+ * @brief The Eigen type which stores @a EigenType according to @a policy,
+ * e.g. ViewMap<layout_policy_t<ArrayNXs<3>, LayoutPolicy::soa>>,
+ * or ViewMap<layout_policy_t<ArrayXXs, LayoutPolicy::padded>>.
+ */
+template<typename EigenType, LayoutPolicy policy>
+using layout_policy_t = typename detail::ApplyLayoutPolicy<EigenType, policy>::Type;
+
+} // namespace Kokkidio
+
+#endif
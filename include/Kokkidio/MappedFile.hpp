@@ -0,0 +1,331 @@
+#ifndef KOKKIDIO_MAPPEDFILE_HPP
+#define KOKKIDIO_MAPPEDFILE_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+/* Memory-mapped files require POSIX mmap */
+#if __has_include(<sys/mman.h>)
+#define KOKKIDIO_HAS_MMAP
+
+#include "Kokkidio/ViewMap.hpp"
+#include "Kokkidio/DualViewMap.hpp"
+#include "Kokkidio/scalarTag.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace Kokkidio
+{
+
+enum class MappedFileAccess {
+	read,
+	readWrite,
+};
+
+namespace detail
+{
+
+/* The file consists of this header, followed by the raw data
+ * in the byte order of the machine which wrote it.
+ * The header size keeps the data 64-byte aligned. */
+struct MappedFileHeader {
+	static constexpr char magicValue[8] {'K','O','K','K','I','D','I','O'};
+	static constexpr std::uint32_t versionValue {1};
+
+	char magic[8];
+	std::uint32_t version;
+	ScalarTag scalar;
+	std::int64_t rows;
+	std::int64_t cols;
+	std::uint32_t rowMajor;
+	unsigned char reserved[28];
+};
+static_assert( sizeof(MappedFileHeader) == 64 );
+static_assert( std::is_trivially_copyable_v<MappedFileHeader> );
+
+} // namespace detail
+
+
+/**
+ * @brief Maps a binary matrix file into host memory via mmap.
+ * Use viewMap<EigenType>(file) or dualViewMap<EigenType>(file)
+ * to access the data without copying it into an Eigen object first.
+ * The MappedFile must outlive all ViewMaps created from it.
+ *
+ * To write a file, create() it with the desired size,
+ * and e.g. use it as the host side of a DualViewMap,
+ * so that copyToHost() writes the target data directly into the file.
+ */
+class MappedFile {
+public:
+	using Header = detail::MappedFileHeader;
+
+protected:
+	std::string m_path;
+	int m_fd {-1};
+	void* m_addr {nullptr};
+	std::size_t m_bytes {0};
+	MappedFileAccess m_access {MappedFileAccess::read};
+
+	MappedFile() = default;
+
+	[[noreturn]] void fail(const std::string& what) const {
+		throw std::system_error(
+			errno, std::generic_category(),
+			"MappedFile (" + this->m_path + "): " + what
+		);
+	}
+
+	void map(){
+		int prot { this->isWritable() ? PROT_READ | PROT_WRITE : PROT_READ };
+		this->m_addr = mmap(
+			nullptr, this->m_bytes, prot, MAP_SHARED, this->m_fd, 0
+		);
+		if ( this->m_addr == MAP_FAILED ){
+			this->m_addr = nullptr;
+			this->fail("mmap failed");
+		}
+	}
+
+	void release(){
+		if (this->m_addr){
+			munmap(this->m_addr, this->m_bytes);
+		}
+		if (this->m_fd >= 0){
+			close(this->m_fd);
+		}
+		this->m_addr  = nullptr;
+		this->m_fd    = -1;
+		this->m_bytes = 0;
+	}
+
+public:
+	/**
+	 * @brief Maps an existing file, which was written by create()
+	 * or writeMappedFile().
+	 * With MappedFileAccess::read, only const Eigen types can be mapped.
+	 */
+	static MappedFile open(
+		const std::string& path,
+		MappedFileAccess access = MappedFileAccess::read
+	){
+		MappedFile file;
+		file.m_path = path;
+		file.m_access = access;
+		file.m_fd = ::open( path.c_str(),
+			access == MappedFileAccess::readWrite ? O_RDWR : O_RDONLY
+		);
+		if (file.m_fd < 0){
+			file.fail("open failed");
+		}
+		struct stat st;
+		if ( fstat(file.m_fd, &st) != 0 ){
+			file.fail("fstat failed");
+		}
+		file.m_bytes = static_cast<std::size_t>(st.st_size);
+		if ( file.m_bytes < sizeof(Header) ){
+			throw std::runtime_error(
+				"MappedFile (" + path + "): file too small for header."
+			);
+		}
+		file.map();
+		const Header& h { file.header() };
+		if ( std::memcmp(h.magic, Header::magicValue, sizeof(h.magic)) != 0 ||
+			h.version != Header::versionValue
+		){
+			throw std::runtime_error(
+				"MappedFile (" + path + "): not a Kokkidio matrix file."
+			);
+		}
+		if ( file.m_bytes < sizeof(Header) + file.dataBytes() ){
+			throw std::runtime_error(
+				"MappedFile (" + path + "): file smaller than stated in header."
+			);
+		}
+		return file;
+	}
+
+	/**
+	 * @brief Creates (or truncates) a file of the right size
+	 * for a @a rows x @a cols object of @a EigenType, and maps it writeable.
+	 * The data is zero-initialised.
+	 */
+	template<typename EigenType>
+	static MappedFile create( const std::string& path, Index rows, Index cols ){
+		using P = std::remove_const_t<
+			typename detail::MapTraits<EigenType>::PlainObjectType
+		>;
+		using Scalar = typename P::Scalar;
+		MappedFile file;
+		file.m_path = path;
+		file.m_access = MappedFileAccess::readWrite;
+		file.m_fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+		if (file.m_fd < 0){
+			file.fail("open failed");
+		}
+		file.m_bytes = sizeof(Header) +
+			sizeof(Scalar) * static_cast<std::size_t>(rows * cols);
+		if ( ftruncate( file.m_fd, static_cast<off_t>(file.m_bytes) ) != 0 ){
+			file.fail("ftruncate failed");
+		}
+		file.map();
+		Header h {};
+		std::memcpy(h.magic, Header::magicValue, sizeof(h.magic));
+		h.version  = Header::versionValue;
+		h.scalar   = detail::scalarTag<Scalar>();
+		h.rows     = static_cast<std::int64_t>(rows);
+		h.cols     = static_cast<std::int64_t>(cols);
+		h.rowMajor = P::IsRowMajor ? 1 : 0;
+		std::memcpy(file.m_addr, &h, sizeof(Header));
+		return file;
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept {
+		*this = std::move(other);
+	}
+
+	MappedFile& operator=(MappedFile&& other) noexcept {
+		if (this != &other){
+			this->release();
+			this->m_path   = std::move(other.m_path);
+			this->m_access = other.m_access;
+			this->m_fd     = std::exchange(other.m_fd, -1);
+			this->m_addr   = std::exchange(other.m_addr, nullptr);
+			this->m_bytes  = std::exchange(other.m_bytes, 0);
+		}
+		return *this;
+	}
+
+	~MappedFile(){
+		this->release();
+	}
+
+	auto header() const -> const Header& {
+		assert( this->m_addr );
+		return *static_cast<const Header*>(this->m_addr);
+	}
+
+	Index rows() const {
+		return static_cast<Index>( this->header().rows );
+	}
+
+	Index cols() const {
+		return static_cast<Index>( this->header().cols );
+	}
+
+	bool isWritable() const {
+		return this->m_access == MappedFileAccess::readWrite;
+	}
+
+	auto path() const -> const std::string& {
+		return this->m_path;
+	}
+
+	std::size_t dataBytes() const {
+		return detail::scalarSize( this->header().scalar ) *
+			static_cast<std::size_t>( this->rows() * this->cols() );
+	}
+
+	/**
+	 * @brief Returns the data pointer,
+	 * after checking that the file holds data of @a EigenType.
+	 */
+	template<typename EigenType>
+	auto data() const -> typename ViewMap<EigenType, Target::host>::Scalar_host* {
+		using P = std::remove_const_t<
+			typename detail::MapTraits<EigenType>::PlainObjectType
+		>;
+		using Scalar = typename P::Scalar;
+		const Header& h { this->header() };
+		auto mismatch = [&](const char* what){
+			throw std::runtime_error(
+				"MappedFile (" + this->m_path + "): " + what + " mismatch."
+			);
+		};
+		if ( h.scalar != detail::scalarTag<Scalar>() ){
+			mismatch("scalar type");
+		}
+		if ( (h.rowMajor != 0) != P::IsRowMajor ){
+			mismatch("storage order");
+		}
+		if ( ( P::RowsAtCompileTime != Eigen::Dynamic &&
+				P::RowsAtCompileTime != h.rows ) ||
+			( P::ColsAtCompileTime != Eigen::Dynamic &&
+				P::ColsAtCompileTime != h.cols )
+		){
+			mismatch("size");
+		}
+		if ( !this->isWritable() &&
+			!std::is_const_v<typename ViewMap<EigenType, Target::host>::Scalar_host>
+		){
+			throw std::runtime_error( "MappedFile (" + this->m_path +
+				"): read-only files can only be mapped to const types."
+			);
+		}
+		return reinterpret_cast<
+			typename ViewMap<EigenType, Target::host>::Scalar_host*
+		>( static_cast<std::byte*>(this->m_addr) + sizeof(Header) );
+	}
+
+	/* Writes modified pages back to the file */
+	void sync() const {
+		if ( this->isWritable() && msync(this->m_addr, this->m_bytes, MS_SYNC) != 0 ){
+			this->fail("msync failed");
+		}
+	}
+};
+
+
+/**
+ * @brief Creates a ViewMap over the data of @a file.
+ * If @a target is the host (the default), then the View is unmanaged
+ * and uses the mapped memory directly.
+ */
+template<typename EigenType, Target target = Target::host>
+ViewMap<EigenType, target> viewMap( const MappedFile& file ){
+	return { file.data<EigenType>(), file.rows(), file.cols() };
+}
+
+/**
+ * @brief Creates a DualViewMap whose host side is the data of @a file.
+ * If @a file is writeable, copyToHost() writes into the file directly.
+ */
+template<typename EigenType, Target target = DefaultTarget>
+DualViewMap<EigenType, target> dualViewMap(
+	const MappedFile& file,
+	DualViewCopyOnInit copyToTarget = CopyToTarget
+){
+	return { file.data<EigenType>(), file.rows(), file.cols(), copyToTarget };
+}
+
+/**
+ * @brief Writes @a obj to a file which can be read with MappedFile::open.
+ */
+template<typename Derived>
+void writeMappedFile( const std::string& path, const Eigen::DenseBase<Derived>& obj ){
+	using P = typename Derived::PlainObject;
+	MappedFile file { MappedFile::create<P>( path, obj.rows(), obj.cols() ) };
+	Eigen::Map<P>( file.data<P>(), obj.rows(), obj.cols() ) = obj;
+	file.sync();
+}
+
+} // namespace Kokkidio
+
+#endif // __has_include(<sys/mman.h>)
+
+#endif
@@ -72,6 +72,21 @@ protected:
 	}
 
 public:
+	/**
+	 * @brief Creates a host ParallelRange over exactly @a rng,
+	 * i.e. without splitting it among the OpenMP threads,
+	 * e.g. for the pieces handed out according to a HostSchedule.
+	 */
+	static ParallelRange fromPiece(
+		const IndexRange<Index>& rng, Index chunkSizeMax = chunk::defaultSize
+	){
+		static_assert(isHost);
+		ParallelRange prng;
+		prng.m_rng = rng;
+		prng.setChunks(chunkSizeMax);
+		return prng;
+	}
+
 	KOKKOS_FUNCTION auto chunkInfo() const -> const ChunkInfo<target>& {
 		return m_chunks;
 	}
@@ -182,9 +197,7 @@ public:
 		static_assert( std::is_invocable_v<Func, ChunkType> );
 
 		if constexpr (isHost){
-			#ifdef KOKKIDIO_OPENMP
-			assert( omp_get_max_threads() == 1 || omp_in_parallel() );
-			#endif
+			assert( detail::host::maxThreads() == 1 || detail::host::inParallel() );
 
 			// for (Index i=0; i<this->nChunks(); ++i){
 			// 	func( this->make_chunk(i) );
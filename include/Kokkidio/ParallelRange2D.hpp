@@ -0,0 +1,287 @@
+#ifndef KOKKIDIO_PARALLELRANGE2D_HPP
+#define KOKKIDIO_PARALLELRANGE2D_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/EigenRange_func.hpp"
+#include "Kokkidio/HostSchedule.hpp"
+
+#include <algorithm>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Rows and columns of a 2D range, i.e. a tile on the host,
+ * and a single element on the device.
+ * Use operator() on Eigen objects, ViewMaps and DualViewMaps,
+ * to get the corresponding block() expression.
+ */
+template<Target _target>
+class EigenRange2D {
+public:
+	static constexpr Target target {_target};
+	static constexpr bool isDevice {target == Target::device};
+	static constexpr bool isHost   {target == Target::host};
+	using MemberType = std::conditional_t<isHost, IndexRange<Index>, int>;
+
+protected:
+	MemberType m_rows, m_cols;
+
+public:
+	KOKKOS_FUNCTION
+	EigenRange2D() = default;
+
+	KOKKOS_FUNCTION
+	EigenRange2D( MemberType rows, MemberType cols ) :
+		m_rows { std::move(rows) },
+		m_cols { std::move(cols) }
+	{}
+
+	KOKKOS_FUNCTION
+	auto rows() const -> const MemberType& {
+		return m_rows;
+	}
+
+	KOKKOS_FUNCTION
+	auto cols() const -> const MemberType& {
+		return m_cols;
+	}
+
+	KOKKOS_FUNCTION
+	constexpr auto size() const -> std::conditional_t<isHost, Index, int> {
+		if constexpr (isHost){
+			return m_rows.size() * m_cols.size();
+		} else {
+			return 1;
+		}
+	}
+
+	/**
+	 * @brief Returns the range moved by @a dRows rows and @a dCols columns,
+	 * e.g. for accessing the neighbours in a stencil.
+	 */
+	KOKKOS_FUNCTION
+	EigenRange2D shifted( Index dRows, Index dCols ) const {
+		if constexpr (isHost){
+			return {
+				{ m_rows.start() + dRows, m_rows.size() },
+				{ m_cols.start() + dCols, m_cols.size() }
+			};
+		} else {
+			return {
+				static_cast<int>(m_rows + dRows),
+				static_cast<int>(m_cols + dCols)
+			};
+		}
+	}
+
+	template<typename EigenObj>
+	KOKKIDIO_INL_AUTO
+	operator() ( EigenObj&& obj ) const {
+		return Kokkidio::blockRange( m_rows, m_cols, std::forward<EigenObj>(obj) );
+	}
+};
+
+
+/**
+ * @brief The argument of functors passed to parallel_for_range2D.
+ * On the host, it refers to one tile of the 2D range,
+ * on the device, to a single element.
+ */
+template<Target _target = DefaultTarget>
+class ParallelRange2D : public EigenRange2D<_target> {
+public:
+	static constexpr Target target {_target};
+	using Base = EigenRange2D<target>;
+	using MemberType = typename Base::MemberType;
+
+	using Base::Base;
+
+	/**
+	 * @brief Calls @a func(i, j) for each row index i and column index j,
+	 * with i running fastest, as in column-major storage.
+	 */
+	template<typename Func>
+	KOKKOS_FUNCTION
+	KOKKIDIO_INLINE
+	void for_each( Func&& func ) const {
+		if constexpr (Base::isDevice){
+			func( this->m_rows, this->m_cols );
+		} else {
+			for ( int j=this->m_cols.start(); j<this->m_cols.end(); ++j ){
+				for ( int i=this->m_rows.start(); i<this->m_rows.end(); ++i ){
+					func(i, j);
+				}
+			}
+		}
+	}
+};
+
+
+/**
+ * @brief Size of the host tiles of parallel_for_range2D.
+ * A size of zero selects a default,
+ * which is up to tile2D::defaultRows rows,
+ * and as many columns as fit into tile2D::defaultBytes
+ * of the scalar type passed to parallel_for_range2D,
+ * so that a tile stays in the L1 cache,
+ * while still giving each thread at least one tile.
+ */
+struct TileSize2D {
+	Index rows {0};
+	Index cols {0};
+};
+
+namespace tile2D
+{
+
+inline constexpr Index defaultRows {256};
+inline constexpr std::size_t defaultBytes {32 * 1024};
+
+} // namespace tile2D
+
+namespace detail
+{
+
+template<typename Policy>
+IndexRange<Index> toIndexRange2D( const Policy& pol ){
+	auto rng { toIndexRange(pol) };
+	return { rng.start(), rng.size() };
+}
+
+inline TileSize2D tileSize2D(
+	TileSize2D tile,
+	const IndexRange<Index>& rows,
+	const IndexRange<Index>& cols,
+	std::size_t elementBytes
+){
+	if ( tile.rows <= 0 ){
+		tile.rows = std::min( rows.size(), tile2D::defaultRows );
+	}
+	if ( tile.cols <= 0 ){
+		tile.cols = static_cast<Index>( tile2D::defaultBytes /
+			( elementBytes * static_cast<std::size_t>( std::max<Index>(1, tile.rows) ) )
+		);
+		/* ...but enough tiles for all threads, if there are few rows */
+		const Index
+			nTileRows { ( rows.size() + tile.rows - 1 ) / std::max<Index>(1, tile.rows) },
+			nThreads  { host::maxThreads() },
+			nTileCols { ( nThreads + nTileRows - 1 ) / std::max<Index>(1, nTileRows) };
+		tile.cols = std::min( tile.cols, ( cols.size() + nTileCols - 1 ) / nTileCols );
+	}
+	tile.rows = std::clamp<Index>( tile.rows, 1, std::max<Index>(1, rows.size()) );
+	tile.cols = std::clamp<Index>( tile.cols, 1, std::max<Index>(1, cols.size()) );
+	return tile;
+}
+
+} // namespace detail
+
+
+/**
+ * @brief Dispatches @a func over the 2D range of @a rows x @a cols,
+ * with a ParallelRange2D<target> as its argument.
+ *
+ * On the host, the range is split into tiles of @a tile,
+ * which are distributed among the threads in column-major order
+ * according to @a sched (the schedule's chunkSize counts tiles),
+ * and @a func is called once per tile.
+ * On the device, this uses a Kokkos::MDRangePolicy,
+ * and @a func is called once per element.
+ *
+ * @tparam Scalar: the scalar type of the data in the tiles,
+ * which sets the default tile width on the host.
+ * @param rows, cols: each either an integer, or an IndexRange.
+ */
+template<
+	Target target = DefaultTarget,
+	typename Scalar = scalar,
+	typename RowPolicy,
+	typename ColPolicy,
+	typename Func
+>
+void parallel_for_range2D(
+	[[maybe_unused]] const HostSchedule& sched,
+	const RowPolicy& rows,
+	const ColPolicy& cols,
+	Func&& func,
+	[[maybe_unused]] TileSize2D tile = {}
+){
+	static_assert( std::is_invocable_v<Func, ParallelRange2D<target>> );
+	const IndexRange<Index>
+		rowRng { detail::toIndexRange2D(rows) },
+		colRng { detail::toIndexRange2D(cols) };
+
+	if constexpr ( target == Target::host ){
+		if ( rowRng.size() <= 0 || colRng.size() <= 0 ){
+			return;
+		}
+		tile = detail::tileSize2D(tile, rowRng, colRng, sizeof(Scalar));
+		const Index
+			nTileRows { ( rowRng.size() + tile.rows - 1 ) / tile.rows },
+			nTileCols { ( colRng.size() + tile.cols - 1 ) / tile.cols };
+		printd( "parallel_for_range2D: %i x %i tiles of %i x %i.\n"
+			, static_cast<int>(nTileRows), static_cast<int>(nTileCols)
+			, static_cast<int>(tile.rows), static_cast<int>(tile.cols)
+		);
+		detail::schedule::forEachPiece( sched,
+			IndexRange<Index>{ 0, nTileRows * nTileCols },
+			[&](const IndexRange<Index>& piece){
+				for ( Index t {piece.start()}; t < piece.end(); ++t ){
+					const Index
+						r { ( t % nTileRows ) * tile.rows },
+						c { ( t / nTileRows ) * tile.cols };
+					func( ParallelRange2D<target>{
+						{ rowRng.start() + r, std::min( tile.rows, rowRng.size() - r ) },
+						{ colRng.start() + c, std::min( tile.cols, colRng.size() - c ) }
+					} );
+				}
+			}
+		);
+	} else {
+		static_assert( target == Target::device );
+		/* column-major: the row index runs fastest */
+		using Policy = Kokkos::MDRangePolicy<
+			ExecutionSpace<target>,
+			Kokkos::Rank<2, Kokkos::Iterate::Left, Kokkos::Iterate::Left>
+		>;
+		using I = typename Policy::index_type;
+		Kokkos::parallel_for(
+			Policy(
+				{ static_cast<I>( rowRng.start() ), static_cast<I>( colRng.start() ) },
+				{ static_cast<I>( rowRng.end()   ), static_cast<I>( colRng.end()   ) }
+			),
+			KOKKOS_LAMBDA(int i, int j){
+				func( ParallelRange2D<target>{i, j} );
+			}
+		);
+	}
+}
+
+/**
+ * @brief Same as parallel_for_range2D(sched, rows, cols, func, tile),
+ * with the default HostSchedule.
+ */
+template<
+	Target target = DefaultTarget,
+	typename Scalar = scalar,
+	typename RowPolicy,
+	typename ColPolicy,
+	typename Func
+>
+void parallel_for_range2D(
+	const RowPolicy& rows,
+	const ColPolicy& cols,
+	Func&& func,
+	TileSize2D tile = {}
+){
+	parallel_for_range2D<target, Scalar>(
+		HostSchedule{}, rows, cols, std::forward<Func>(func), tile
+	);
+}
+
+} // namespace Kokkidio
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "Kokkidio/ViewMap.hpp"
 #include "Kokkidio/IndexRange.hpp"
+#include "Kokkidio/hostThreads.hpp"
 
 #include <memory>
 #include <vector>
@@ -104,13 +105,16 @@ struct DeviceBuffer {
 };
 
 
-template<typename _ColType>
+/* With HostMemoryPolicy::hugepages,
+ * the buffers are advised to use huge pages, see HostMemoryPolicy. */
+template<typename _ColType, HostMemoryPolicy _hostMemory = HostMemoryPolicy::pageable>
 class HostBuffer {
 public:
 	using ColType = _ColType;
 	using Scalar = typename ColType::Scalar;
 	static constexpr auto target {Target::host};
-	using MemorySpace = Kokkidio::MemorySpace<target>;
+	static constexpr HostMemoryPolicy hostMemory {_hostMemory};
+	using MemorySpace = Kokkidio::MemorySpace<target, hostMemory>;
 	using LoopType    = chunk::LoopType<target, ColType>;
 
 	using DataType = Scalar***;
@@ -137,6 +141,11 @@ protected:
 			cols,
 			this->maxThreads()
 		};
+		if constexpr ( hostMemory == HostMemoryPolicy::hugepages ){
+			detail::adviseHugePages(
+				this->m_view.data(), this->m_view.span() * sizeof(Scalar)
+			);
+		}
 		printd(
 			"HostBuffer::set: range [%i, %i), chunkSizeMax = %i\n"
 			"\t(%p) View extents: (%lu, %lu, %lu)\n"
@@ -151,18 +160,14 @@ protected:
 
 public:
 	static std::size_t maxThreads(){
-		#ifdef _OPENMP
-		return omp_get_max_threads();
-		#else
-		return 1;
-		#endif
+		return static_cast<std::size_t>( detail::host::maxThreads() );
 	}
 
 	HostBuffer() = default;
 
 	/**
 	 * @brief Creates a chunk buffers for each thread.
-	 * Uses omp_get_max_threads as the number of threads,
+	 * Uses omp_get_max_threads (or the ThreadPool size) as the number of threads,
 	 * the number of rows of @a ColType, i.e. @a RowsAtCompileTime,
 	 * and @a chunkSizeMax as the number of columns.
 	 * If a Kokkos::RangePolicy is used as the parameter,
@@ -179,7 +184,7 @@ public:
 
 	/**
 	 * @brief Creates a chunk buffers for each thread.
-	 * Uses omp_get_max_threads as the number of threads,
+	 * Uses omp_get_max_threads (or the ThreadPool size) as the number of threads,
 	 * and the number of rows of @a ColType, i.e. @a RowsAtCompileTime.
 	 * The number of columns is set to the chunk size, 
 	 * which is set to Kokkos::RangePolicy::chunk_size 
@@ -200,12 +205,9 @@ public:
 
 public:
 	LoopType get( const Chunk<Target::host>& chunk ) const {
-		#ifdef _OPENMP
-		assert( ( omp_get_max_threads() == 1 || omp_in_parallel() ) );
-		int threadNo { omp_get_thread_num() };
-		#else
-		int threadNo {0};
-		#endif
+		/* the OpenMP thread number, or the ThreadPool's worker index */
+		assert( ( detail::host::maxThreads() == 1 || detail::host::inParallel() ) );
+		int threadNo { detail::host::threadNum() };
 
 		// #ifndef __CUDACC__
 		printdl(
@@ -233,10 +235,10 @@ public:
 };
 
 
-template<typename ColType, Target target>
+template<typename ColType, Target target, HostMemoryPolicy hostMemory>
 struct Buffer {
 	using Type = std::conditional_t<target == Target::host,
-		HostBuffer<ColType>,
+		HostBuffer<ColType, hostMemory>,
 		DeviceBuffer<ColType>
 	>;
 };
@@ -244,8 +246,11 @@ struct Buffer {
 } // namespace chunk
 
 
-template<typename ColType, Target target>
-using ChunkBuffer = typename chunk::Buffer<ColType, target>::Type;
+template<
+	typename ColType, Target target,
+	HostMemoryPolicy hostMemory = HostMemoryPolicy::pageable
+>
+using ChunkBuffer = typename chunk::Buffer<ColType, target, hostMemory>::Type;
 
 
 
@@ -254,7 +259,7 @@ using ChunkBuffer = typename chunk::Buffer<ColType, target>::Type;
  * @brief Creates a target-specific buffer, whose columns behave like @a ColType.
  * If @a target is Target::host, then a chunk buffer is created for each thread.
  * In that case, it uses
- * omp_get_max_threads as the number of threads,
+ * omp_get_max_threads (or the ThreadPool size) as the number of threads,
  * @a ColType::RowsAtCompileTime as the number of rows,
  * and @a chunkSizeMax as the number of columns.
  * If a Kokkos::RangePolicy is used as the parameter,
@@ -268,16 +273,21 @@ using ChunkBuffer = typename chunk::Buffer<ColType, target>::Type;
  * 
  * @tparam ColType 
  * @tparam target 
+ * @tparam hostMemory only applies to Target::host, see HostMemoryPolicy.
  * @tparam Policy 
  * @param pol 
  * @param chunkSizeMax 
- * @return ChunkBuffer<ColType, target> 
+ * @return ChunkBuffer<ColType, target, hostMemory> 
  */
-template<typename ColType, Target target, typename Policy>
-ChunkBuffer<ColType, target>
+template<
+	typename ColType, Target target,
+	HostMemoryPolicy hostMemory = HostMemoryPolicy::pageable,
+	typename Policy
+>
+ChunkBuffer<ColType, target, hostMemory>
 makeBuffer( const Policy& pol, Index chunkSizeMax ){
 	if constexpr (target == Target::host){
-		return chunk::HostBuffer<ColType>(pol, chunkSizeMax);
+		return chunk::HostBuffer<ColType, hostMemory>(pol, chunkSizeMax);
 	} else {
 		return {};
 	}
@@ -289,7 +299,7 @@ makeBuffer( const Policy& pol, Index chunkSizeMax ){
  * @brief Creates a target-specific buffer, whose columns behave like @a ColType.
  * If @a target is Target::host, then a chunk buffer is created for each thread.
  * In that case, it uses
- * omp_get_max_threads as the number of threads,
+ * omp_get_max_threads (or the ThreadPool size) as the number of threads,
  * @a ColType::RowsAtCompileTime as the number of rows,
  * and @a chunkSizeMax as the number of columns.
  * If a Kokkos::RangePolicy is used as the parameter,
@@ -303,14 +313,19 @@ makeBuffer( const Policy& pol, Index chunkSizeMax ){
  * 
  * @tparam ColType 
  * @tparam target 
+ * @tparam hostMemory only applies to Target::host, see HostMemoryPolicy.
  * @tparam Policy 
  * @param pol 
- * @return ChunkBuffer<ColType, target> 
+ * @return ChunkBuffer<ColType, target, hostMemory> 
  */
-template<typename ColType, Target target, typename Policy>
-ChunkBuffer<ColType, target>
+template<
+	typename ColType, Target target,
+	HostMemoryPolicy hostMemory = HostMemoryPolicy::pageable,
+	typename Policy
+>
+ChunkBuffer<ColType, target, hostMemory>
 makeBuffer( const Policy& pol ){
-	return makeBuffer<ColType, target>( pol, [&](){
+	return makeBuffer<ColType, target, hostMemory>( pol, [&](){
 		if constexpr (is_RangePolicy_v<Policy>){
 			return pol.chunk_size();
 		} else {
@@ -321,10 +336,10 @@ makeBuffer( const Policy& pol ){
 
 
 /* on host */
-template<typename ColType>
-typename ChunkBuffer<ColType, Target::host>::LoopType
+template<typename ColType, HostMemoryPolicy hostMemory>
+typename ChunkBuffer<ColType, Target::host, hostMemory>::LoopType
 getBuffer(
-	const chunk::HostBuffer<ColType>& chunkBuf,
+	const chunk::HostBuffer<ColType, hostMemory>& chunkBuf,
 	const Chunk<Target::host>& chunk
 ){
 	return chunkBuf.get(chunk);
@@ -15,6 +15,41 @@
 namespace Kokkidio
 {
 
+/**
+ * @brief Which memory space host data is allocated in.
+ *
+ * pageable is the default host memory space.
+ *
+ * pinned uses page-locked memory (Kokkos::SharedHostPinnedSpace),
+ * which allows transfers to and from the device at a higher bandwidth,
+ * and without blocking the host when they are asynchronous.
+ * Page-locked memory is a limited resource, so it is opt-in.
+ * Without a device, or if Kokkos does not provide SharedHostPinnedSpace,
+ * pinned falls back to pageable.
+ *
+ * shared uses memory which is accessible from both host and device
+ * (Kokkos::SharedSpace), and, unlike the other policies,
+ * also applies to allocations on the device.
+ * A DualViewMap then uses a single allocation for both sides,
+ * and its transfers only prefetch the data.
+ * Without a device, this is host memory, i.e. the zero-copy path of
+ * Target::host. If Kokkos does not provide SharedSpace,
+ * shared falls back to pageable.
+ *
+ * hugepages is pageable memory, for which transparent huge pages (2 MB)
+ * are requested via madvise, to reduce TLB misses on large arrays.
+ * Whether the kernel grants them depends on its configuration
+ * (/sys/kernel/mm/transparent_hugepage/enabled must not be "never").
+ * Otherwise, or on systems other than Linux,
+ * the memory is backed by regular pages.
+ */
+enum class HostMemoryPolicy {
+	pageable,
+	pinned,
+	shared,
+	hugepages,
+};
+
 namespace detail
 {
 
@@ -27,9 +62,42 @@ struct ExecutionSpace {
 		>;
 };
 
-template<Target targetArg>
+template<HostMemoryPolicy policy>
+struct HostMemorySpace {
+	using Type = typename Kokkos::DefaultHostExecutionSpace::memory_space;
+};
+
+#ifdef KOKKOS_HAS_SHARED_HOST_PINNED_SPACE
+template<>
+struct HostMemorySpace<HostMemoryPolicy::pinned> {
+	using Type = std::conditional_t<
+		std::is_same_v<Kokkos::DefaultExecutionSpace, Kokkos::DefaultHostExecutionSpace>,
+		typename Kokkos::DefaultHostExecutionSpace::memory_space,
+		Kokkos::SharedHostPinnedSpace
+	>;
+};
+#endif
+
+#ifdef KOKKOS_HAS_SHARED_SPACE
+template<>
+struct HostMemorySpace<HostMemoryPolicy::shared> {
+	using Type = std::conditional_t<
+		std::is_same_v<Kokkos::DefaultExecutionSpace, Kokkos::DefaultHostExecutionSpace>,
+		typename Kokkos::DefaultHostExecutionSpace::memory_space,
+		Kokkos::SharedSpace
+	>;
+};
+#endif
+
+/* The host memory policy only applies to Target::host,
+ * except for shared memory, which is accessible from both targets */
+template<Target targetArg, HostMemoryPolicy policy = HostMemoryPolicy::pageable>
 struct MemorySpace {
-	using Type = typename ExecutionSpace<targetArg>::Type::memory_space;
+	using Type = std::conditional_t<
+		targetArg == Target::host || policy == HostMemoryPolicy::shared,
+		typename HostMemorySpace<policy>::Type,
+		typename ExecutionSpace<targetArg>::Type::memory_space
+	>;
 };
 
 
@@ -60,7 +128,16 @@ public:
 		Scalar[Rows][Cols],
 		Scalar**
 	>;
-	using Type = Kokkos::View<DataType, Kokkos::LayoutLeft, MemorySpace>;
+	/* Column-major types map to LayoutLeft, row-major types to LayoutRight,
+	 * and Eigen::Maps with an outer stride to LayoutStride. */
+	static constexpr bool
+		IsRowMajor     {P::IsRowMajor},
+		HasOuterStride {has_outer_stride_v<P>};
+	using Layout = std::conditional_t<HasOuterStride,
+		Kokkos::LayoutStride,
+		std::conditional_t<IsRowMajor, Kokkos::LayoutRight, Kokkos::LayoutLeft>
+	>;
+	using Type = Kokkos::View<DataType, Layout, MemorySpace>;
 };
 
 template<Target targetArg>
@@ -82,6 +159,24 @@ inline constexpr Target spaceToTarget {
 	Target::host : DefaultTarget
 };
 
+/* Without a device, all memory is shared between host and target */
+inline constexpr bool hasSharedSpace {
+	#ifdef KOKKOS_HAS_SHARED_SPACE
+	true
+	#else
+	DefaultTarget == Target::host
+	#endif
+};
+
+/* The policy which is actually used for @a target,
+ * see HostMemoryPolicy */
+template<Target target, HostMemoryPolicy policy>
+inline constexpr HostMemoryPolicy hostMemoryPolicy {
+	policy == HostMemoryPolicy::shared ?
+		( hasSharedSpace ? policy : HostMemoryPolicy::pageable ) :
+		( target == Target::host ? policy : HostMemoryPolicy::pageable )
+};
+
 } // namespace detail
 
 
@@ -96,8 +191,8 @@ inline constexpr Target spaceToTarget { detail::spaceToTarget<Space> };
 template<Target targetArg>
 using ExecutionSpace = typename detail::ExecutionSpace<targetArg>::Type;
 
-template<Target targetArg>
-using MemorySpace = typename detail::MemorySpace<targetArg>::Type;
+template<Target targetArg, HostMemoryPolicy policy = HostMemoryPolicy::pageable>
+using MemorySpace = typename detail::MemorySpace<targetArg, policy>::Type;
 
 template<typename PlainObjectType, typename MemorySpace>
 using ViewType = typename detail::ViewType<PlainObjectType, MemorySpace>::Type;
@@ -0,0 +1,296 @@
+#ifndef KOKKIDIO_THREADPOOL_HPP
+#define KOKKIDIO_THREADPOOL_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/IndexRange.hpp"
+#include "Kokkidio/typeAliases.hpp"
+#include "Kokkidio/macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief A persistent pool of worker threads with work-stealing,
+ * which runs the host kernels instead of OpenMP,
+ * if Kokkidio is compiled with KOKKIDIO_HOST_THREADPOOL.
+ *
+ * Each worker has its own deque of pieces (column ranges).
+ * A dispatch from outside the pool hands each worker
+ * a contiguous segment of the range, split into pieces.
+ * Workers take pieces from the back of their own deque,
+ * and when that runs empty, steal from the front of the others' deques.
+ * Idle workers sleep until new pieces arrive.
+ *
+ * A dispatch from inside a kernel, i.e. from a worker,
+ * puts its pieces into that worker's deque, from where idle workers
+ * can steal them. Instead of blocking, the worker then helps
+ * with the pieces of that dispatch, until all of them are done.
+ * That way, Kokkidio kernels can be nested,
+ * and called from any number of application threads,
+ * without ever running more threads than the pool has.
+ *
+ * The number of workers is taken from the environment variable
+ * KOKKIDIO_NUM_THREADS, or otherwise std::thread::hardware_concurrency.
+ */
+class ThreadPool {
+public:
+	using Piece = IndexRange<Index>;
+
+protected:
+	/* One call to forEachPiece. Lives on the stack of the dispatching thread,
+	 * which waits until all of its pieces are done. */
+	struct Job {
+		void (*run)(const void*, const Piece&) {nullptr};
+		const void* func {nullptr};
+		std::atomic<Index> pending {0};
+		std::atomic<bool> failed {false};
+		std::exception_ptr error;
+	};
+
+	struct Task {
+		Job* job;
+		Piece piece;
+	};
+
+	/* Each worker's deque has its own cache line */
+	struct alignas(64) Worker {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<std::thread> m_threads;
+	std::atomic<Index> m_queued {0};
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wake, m_done;
+	bool m_stop {false};
+
+	static int& currentWorker(){
+		thread_local int index {-1};
+		return index;
+	}
+
+	static int defaultSize(){
+		if ( const char* env { std::getenv("KOKKIDIO_NUM_THREADS") } ){
+			int n { std::atoi(env) };
+			if (n > 0){
+				return n;
+			}
+		}
+		return std::max( 1, static_cast<int>( std::thread::hardware_concurrency() ) );
+	}
+
+	explicit ThreadPool(int nWorkers){
+		printd( "Starting ThreadPool with %i workers.\n", nWorkers );
+		for (int i {0}; i < nWorkers; ++i){
+			this->m_workers.emplace_back( std::make_unique<Worker>() );
+		}
+		for (int i {0}; i < nWorkers; ++i){
+			this->m_threads.emplace_back( [this, i]{ this->work(i); } );
+		}
+	}
+
+	/* Takes a piece from the back of worker @a w's own deque,
+	 * or from the front of any other deque.
+	 * If @a only is set, then only pieces of that job are taken. */
+	bool take( int w, const Job* only, Task& task ){
+		auto takeFrom = [&](int v, bool back){
+			Worker& victim { *this->m_workers[v] };
+			std::lock_guard<std::mutex> lock {victim.mutex};
+			if ( victim.tasks.empty() ){
+				return false;
+			}
+			const Task& t { back ? victim.tasks.back() : victim.tasks.front() };
+			if ( only && t.job != only ){
+				return false;
+			}
+			task = t;
+			if (back){
+				victim.tasks.pop_back();
+			} else {
+				victim.tasks.pop_front();
+			}
+			this->m_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		};
+		if ( takeFrom(w, true) ){
+			return true;
+		}
+		const int n { this->size() };
+		for (int k {1}; k < n; ++k){
+			if ( takeFrom( (w + k) % n, false ) ){
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void run( const Task& task ){
+		Job& job { *task.job };
+		if ( !job.failed.load(std::memory_order_relaxed) ){
+			try {
+				job.run(job.func, task.piece);
+			} catch (...) {
+				if ( !job.failed.exchange(true) ){
+					job.error = std::current_exception();
+				}
+			}
+		}
+		if ( job.pending.fetch_sub(1, std::memory_order_acq_rel) == 1 ){
+			/* lock, so that the dispatching thread cannot miss the notification
+			 * between checking the counter and going to sleep */
+			std::lock_guard<std::mutex> lock {this->m_sleepMutex};
+			this->m_done.notify_all();
+		}
+	}
+
+	void work(int w){
+		currentWorker() = w;
+		Task task;
+		while (true){
+			if ( this->take(w, nullptr, task) ){
+				this->run(task);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock {this->m_sleepMutex};
+			this->m_wake.wait( lock, [&]{
+				return this->m_stop || this->m_queued.load() > 0;
+			});
+			if ( this->m_stop && this->m_queued.load() == 0 ){
+				return;
+			}
+		}
+	}
+
+	void push( int w, Job& job, Index start, Index end, Index chunk ){
+		Worker& worker { *this->m_workers[w] };
+		std::lock_guard<std::mutex> lock {worker.mutex};
+		for (Index i {start}; i < end; i += chunk){
+			worker.tasks.push_back( {&job, Piece{ i, std::min(chunk, end - i) }} );
+		}
+	}
+
+	void wake( Index nPieces ){
+		this->m_queued.fetch_add(nPieces);
+		{
+			std::lock_guard<std::mutex> lock {this->m_sleepMutex};
+		}
+		this->m_wake.notify_all();
+	}
+
+public:
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool(){
+		{
+			std::lock_guard<std::mutex> lock {this->m_sleepMutex};
+			this->m_stop = true;
+		}
+		this->m_wake.notify_all();
+		for (auto& thread : this->m_threads){
+			thread.join();
+		}
+	}
+
+	/**
+	 * @brief Returns the pool, which is started on the first call,
+	 * and persists until the end of the program.
+	 */
+	static ThreadPool& instance(){
+		static ThreadPool pool { defaultSize() };
+		return pool;
+	}
+
+	int size() const {
+		return static_cast<int>( this->m_workers.size() );
+	}
+
+	/**
+	 * @brief Returns the index of the calling worker in [0, size()),
+	 * or -1, if called from a thread outside the pool.
+	 */
+	static int workerIndex(){
+		return currentWorker();
+	}
+
+	/**
+	 * @brief Calls @a func with every piece of @a range,
+	 * each of which has a size of at most @a chunk,
+	 * and returns when all calls have finished.
+	 * Exceptions thrown by @a func are rethrown here,
+	 * after the remaining pieces were skipped.
+	 * May be called from inside @a func, and from any thread.
+	 */
+	template<typename Func>
+	void forEachPiece( const Piece& range, Index chunk, const Func& func ){
+		if ( range.size() <= 0 ){
+			return;
+		}
+		chunk = std::max<Index>(1, chunk);
+		const Index nPieces { (range.size() + chunk - 1) / chunk };
+		Job job;
+		job.run = [](const void* f, const Piece& piece){
+			( *static_cast<const Func*>(f) )(piece);
+		};
+		job.func = &func;
+		job.pending.store(nPieces);
+
+		const int self { workerIndex() };
+		if (self >= 0){
+			/* nested: help with this job's pieces until it is done,
+			 * without taking on any other work in the meantime */
+			this->push( self, job, range.start(), range.end(), chunk );
+			this->wake(nPieces);
+			Task task;
+			while ( job.pending.load(std::memory_order_acquire) > 0 ){
+				if ( this->take(self, &job, task) ){
+					this->run(task);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		} else {
+			/* each worker gets a contiguous segment of whole pieces */
+			const int n { this->size() };
+			Index pieceStart {0};
+			for (int w {0}; w < n; ++w){
+				Index pieceEnd { nPieces * (w + 1) / n };
+				if (pieceEnd > pieceStart){
+					this->push( w, job,
+						range.start() + pieceStart * chunk,
+						std::min( range.end(), range.start() + pieceEnd * chunk ),
+						chunk
+					);
+				}
+				pieceStart = pieceEnd;
+			}
+			this->wake(nPieces);
+			std::unique_lock<std::mutex> lock {this->m_sleepMutex};
+			this->m_done.wait( lock, [&]{
+				return job.pending.load(std::memory_order_acquire) == 0;
+			});
+		}
+		if (job.error){
+			std::rethrow_exception(job.error);
+		}
+	}
+};
+
+} // namespace Kokkidio
+
+#endif
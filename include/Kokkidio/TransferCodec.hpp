@@ -0,0 +1,402 @@
+#ifndef KOKKIDIO_TRANSFERCODEC_HPP
+#define KOKKIDIO_TRANSFERCODEC_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/TargetSpaces.hpp"
+#include "Kokkidio/macros.hpp"
+
+#include <Kokkos_Core.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Optional encoding of DualViewMap transfers,
+ * e.g. DualViewMap::copyToTarget(TransferCodec),
+ * for data which compresses well.
+ *
+ * The data is encoded in blocks on the source side,
+ * only the encoded bytes are transferred,
+ * and the blocks are decoded in parallel on the destination side.
+ * Both codecs are lossless, and blocks which would not shrink
+ * are transferred unchanged.
+ *
+ * rle (run-length encoding) stores runs of identical values only once,
+ * e.g. for masks with many zeros.
+ *
+ * delta stores the differences between the bit patterns of consecutive
+ * values as variable-length integers, e.g. for slowly varying fields.
+ */
+enum class TransferCodec {
+	none,
+	rle,
+	delta,
+};
+
+namespace detail::codec
+{
+
+/* Number of elements in each independently en-/decoded block */
+inline constexpr int blockSize {1024};
+
+template<typename Scalar>
+using Bits =
+	std::conditional_t<sizeof(Scalar) == 8, std::uint64_t,
+	std::conditional_t<sizeof(Scalar) == 4, std::uint32_t,
+	std::conditional_t<sizeof(Scalar) == 2, std::uint16_t,
+		std::uint8_t
+	>>>;
+
+template<typename Scalar>
+KOKKOS_INLINE_FUNCTION
+Bits<Scalar> toBits( const Scalar& val ){
+	Bits<Scalar> bits;
+	memcpy( &bits, &val, sizeof(Scalar) );
+	return bits;
+}
+
+template<typename Scalar>
+KOKKOS_INLINE_FUNCTION
+Scalar fromBits( Bits<Scalar> bits ){
+	Scalar val;
+	memcpy( &val, &bits, sizeof(Scalar) );
+	return val;
+}
+
+/* Maps small negative differences to small unsigned numbers */
+template<typename U>
+KOKKOS_INLINE_FUNCTION
+U zigzag( U diff ){
+	constexpr int msb { 8 * sizeof(U) - 1 };
+	return static_cast<U>( (diff << 1) ^ static_cast<U>( U{0} - (diff >> msb) ) );
+}
+
+template<typename U>
+KOKKOS_INLINE_FUNCTION
+U unzigzag( U val ){
+	return static_cast<U>( (val >> 1) ^ static_cast<U>( U{0} - (val & U{1}) ) );
+}
+
+/* Only counts the bytes, if out is a nullptr */
+struct Writer {
+	std::byte* out;
+	std::size_t pos {0};
+
+	KOKKOS_INLINE_FUNCTION
+	void put( unsigned int byte ){
+		if (this->out){
+			this->out[this->pos] = static_cast<std::byte>(byte & 0xffu);
+		}
+		++(this->pos);
+	}
+
+	template<typename U>
+	KOKKOS_INLINE_FUNCTION
+	void putBits( U val ){
+		for (std::size_t i {0}; i < sizeof(U); ++i){
+			this->put( static_cast<unsigned int>( val >> (8 * i) ) );
+		}
+	}
+
+	template<typename U>
+	KOKKOS_INLINE_FUNCTION
+	void putVarint( U val ){
+		while ( val >= 0x80u ){
+			this->put( static_cast<unsigned int>(val & 0x7fu) | 0x80u );
+			val = static_cast<U>(val >> 7);
+		}
+		this->put( static_cast<unsigned int>(val) );
+	}
+};
+
+struct Reader {
+	const std::byte* in;
+	std::size_t pos {0};
+
+	KOKKOS_INLINE_FUNCTION
+	unsigned int get(){
+		return static_cast<unsigned int>( this->in[ (this->pos)++ ] );
+	}
+
+	template<typename U>
+	KOKKOS_INLINE_FUNCTION
+	U getBits(){
+		U val {0};
+		for (std::size_t i {0}; i < sizeof(U); ++i){
+			val = static_cast<U>( val | static_cast<U>(
+				static_cast<U>( this->get() ) << (8 * i)
+			) );
+		}
+		return val;
+	}
+
+	template<typename U>
+	KOKKOS_INLINE_FUNCTION
+	U getVarint(){
+		U val {0};
+		unsigned int shift {0};
+		unsigned int byte;
+		do {
+			byte = this->get();
+			val = static_cast<U>( val | static_cast<U>(
+				static_cast<U>(byte & 0x7fu) << shift
+			) );
+			shift += 7;
+		} while ( byte & 0x80u );
+		return val;
+	}
+};
+
+/* Returns the encoded size of a block of @a n elements.
+ * Stops early, once the raw size is reached,
+ * because such blocks are transferred unchanged. */
+template<typename Scalar>
+KOKKOS_INLINE_FUNCTION
+std::size_t encodeBlock(
+	TransferCodec codec, const Scalar* src, int n, std::byte* out
+){
+	using U = Bits<Scalar>;
+	const std::size_t rawBytes { n * sizeof(Scalar) };
+	Writer w {out};
+	if ( codec == TransferCodec::rle ){
+		int i {0};
+		while ( i < n && w.pos < rawBytes ){
+			const U val { toBits( src[i] ) };
+			int run {1};
+			while ( i + run < n && toBits( src[i + run] ) == val ){
+				++run;
+			}
+			w.putBits(val);
+			w.putVarint( static_cast<unsigned int>(run) );
+			i += run;
+		}
+	} else {
+		U prev {0};
+		for ( int i {0}; i < n && w.pos < rawBytes; ++i ){
+			const U cur { toBits( src[i] ) };
+			w.putVarint( zigzag( static_cast<U>(cur - prev) ) );
+			prev = cur;
+		}
+	}
+	return w.pos;
+}
+
+template<typename Scalar>
+KOKKOS_INLINE_FUNCTION
+void decodeBlock(
+	TransferCodec codec, const std::byte* in, std::size_t bytes,
+	Scalar* dst, int n
+){
+	using U = Bits<Scalar>;
+	if ( bytes == n * sizeof(Scalar) ){
+		memcpy( dst, in, bytes );
+		return;
+	}
+	Reader r {in};
+	if ( codec == TransferCodec::rle ){
+		int i {0};
+		while (i < n){
+			const Scalar val { fromBits<Scalar>( r.getBits<U>() ) };
+			const int run { static_cast<int>( r.getVarint<unsigned int>() ) };
+			for ( int k {0}; k < run; ++k ){
+				dst[i++] = val;
+			}
+		}
+	} else {
+		U prev {0};
+		for ( int i {0}; i < n; ++i ){
+			prev = static_cast<U>( prev + unzigzag( r.getVarint<U>() ) );
+			dst[i] = fromBits<Scalar>(prev);
+		}
+	}
+}
+
+/* Host-side buffers use page-locked memory, if available */
+template<typename ExecutionSpace>
+using BufferSpace = std::conditional_t<
+	std::is_same_v<ExecutionSpace, Kokkos::DefaultHostExecutionSpace>,
+	Kokkidio::MemorySpace<Target::host, HostMemoryPolicy::pinned>,
+	typename ExecutionSpace::memory_space
+>;
+
+/* Worst case by which an encoded block can exceed its raw size,
+ * because encodeBlock only stops between two entries */
+inline constexpr std::size_t blockSlack {16};
+
+/**
+ * @brief Byte buffer on one side of transfer(),
+ * which is only reallocated when a larger one is needed,
+ * so that repeated transfers (e.g. by the same DualViewMap) don't allocate.
+ */
+template<typename ExecutionSpace>
+class Buffer {
+public:
+	using ViewType = Kokkos::View<std::byte*, BufferSpace<ExecutionSpace>>;
+
+protected:
+	ViewType m_view;
+
+public:
+	std::byte* reserve( std::size_t bytes ){
+		if ( this->m_view.extent(0) < bytes ){
+			/* release the old buffer first */
+			this->m_view = {};
+			this->m_view = ViewType{
+				Kokkos::view_alloc( Kokkos::WithoutInitializing, "Kokkidio::codec::buffer" ),
+				bytes
+			};
+		}
+		return this->m_view.data();
+	}
+};
+
+/**
+ * @brief Copies @a n contiguous elements from @a src,
+ * which is accessible from @a SrcSpace, to @a dst,
+ * which is accessible from @a DstSpace, using @a codec.
+ * The copy is synchronous.
+ *
+ * Each block is encoded once on the source side,
+ * into its own slot of @a buf_src, and the encoded blocks are then packed
+ * into a contiguous range of @a buf_src, which is transferred to @a buf_dst.
+ */
+template<typename SrcSpace, typename DstSpace, typename Scalar>
+void transfer(
+	TransferCodec codec, Scalar* dst, const Scalar* src, std::size_t n,
+	Buffer<SrcSpace>& buf_src, Buffer<DstSpace>& buf_dst
+){
+	static_assert( std::is_trivially_copyable_v<Scalar> );
+	static_assert( sizeof(Bits<Scalar>) == sizeof(Scalar),
+		"TransferCodec supports scalar types of 1, 2, 4, or 8 bytes."
+	);
+	using SrcMem = BufferSpace<SrcSpace>;
+	using DstMem = BufferSpace<DstSpace>;
+	using Offsets = std::uint64_t;
+	using Unmanaged = Kokkos::MemoryTraits<Kokkos::Unmanaged>;
+	constexpr bool srcIsHost {
+		std::is_same_v<SrcSpace, Kokkos::DefaultHostExecutionSpace>
+	};
+
+	/* without blocks, there would be no offsets to scan */
+	if (n == 0){
+		return;
+	}
+
+	const int nBlocks { static_cast<int>( (n + blockSize - 1) / blockSize ) };
+	auto blockElems = KOKKOS_LAMBDA(int b) -> int {
+		const std::size_t rest { n - static_cast<std::size_t>(b) * blockSize };
+		return rest < static_cast<std::size_t>(blockSize) ?
+			static_cast<int>(rest) : blockSize;
+	};
+
+	/* Source buffer: offsets, packed blocks, and one slot per block.
+	 * Destination buffer: offsets and packed blocks.
+	 * The packed blocks are at most as large as the raw data. */
+	const std::size_t
+		offsetBytes { (nBlocks + 1) * sizeof(Offsets) },
+		rawBytes    { n * sizeof(Scalar) },
+		slotBytes   { blockSize * sizeof(Scalar) + blockSlack };
+	std::byte* bufSrc { buf_src.reserve(
+		offsetBytes + rawBytes + nBlocks * slotBytes
+	) };
+	std::byte* bufDst { buf_dst.reserve( offsetBytes + rawBytes ) };
+
+	Offsets* offs { reinterpret_cast<Offsets*>(bufSrc) };
+	std::byte* packed { bufSrc + offsetBytes };
+	std::byte* slots { packed + rawBytes };
+
+	/* block sizes, stored at b + 1 */
+	Kokkos::parallel_for( "Kokkidio::codec::encode",
+		Kokkos::RangePolicy<SrcSpace>(0, nBlocks),
+		KOKKOS_LAMBDA(int b){
+			const int elems { blockElems(b) };
+			const std::size_t blockBytes { elems * sizeof(Scalar) };
+			const std::size_t bytes { encodeBlock<Scalar>( codec,
+				src + static_cast<std::size_t>(b) * blockSize, elems,
+				slots + b * slotBytes
+			) };
+			offs[b + 1] = bytes < blockBytes ? bytes : blockBytes;
+			if (b == 0){
+				offs[0] = 0;
+			}
+		}
+	);
+	/* inclusive scan turns the sizes into offsets */
+	Kokkos::parallel_scan( "Kokkidio::codec::offsets",
+		Kokkos::RangePolicy<SrcSpace>(0, nBlocks + 1),
+		KOKKOS_LAMBDA(int i, Offsets& sum, bool final){
+			sum += offs[i];
+			if (final){
+				offs[i] = sum;
+			}
+		}
+	);
+	/* blocks which would not shrink are packed unchanged */
+	Kokkos::parallel_for( "Kokkidio::codec::pack",
+		Kokkos::RangePolicy<SrcSpace>(0, nBlocks),
+		KOKKOS_LAMBDA(int b){
+			const std::size_t bytes { offs[b + 1] - offs[b] };
+			if ( bytes == blockElems(b) * sizeof(Scalar) ){
+				memcpy( packed + offs[b],
+					src + static_cast<std::size_t>(b) * blockSize, bytes
+				);
+			} else {
+				memcpy( packed + offs[b], slots + b * slotBytes, bytes );
+			}
+		}
+	);
+
+	const std::size_t nOffsets { static_cast<std::size_t>(nBlocks + 1) };
+	Kokkos::View<Offsets*, DstMem, Unmanaged> offsets_dst {
+		reinterpret_cast<Offsets*>(bufDst), nOffsets
+	};
+	Kokkos::deep_copy( offsets_dst,
+		Kokkos::View<Offsets*, SrcMem, Unmanaged>{ offs, nOffsets }
+	);
+	const std::size_t total { srcIsHost ?
+		offs[nBlocks] : offsets_dst(nBlocks)
+	};
+	printd( "codec::transfer: %zu bytes encoded to %zu bytes.\n"
+		, rawBytes, total
+	);
+
+	const std::byte* in { bufDst + offsetBytes };
+	Kokkos::deep_copy(
+		Kokkos::View<std::byte*, DstMem, Unmanaged>{ bufDst + offsetBytes, total },
+		Kokkos::View<std::byte*, SrcMem, Unmanaged>{ packed, total }
+	);
+
+	const Offsets* offs_dst { offsets_dst.data() };
+	Kokkos::parallel_for( "Kokkidio::codec::decode",
+		Kokkos::RangePolicy<DstSpace>(0, nBlocks),
+		KOKKOS_LAMBDA(int b){
+			decodeBlock<Scalar>( codec,
+				in + offs_dst[b], offs_dst[b + 1] - offs_dst[b],
+				dst + static_cast<std::size_t>(b) * blockSize, blockElems(b)
+			);
+		}
+	);
+	Kokkos::fence("Kokkidio::codec::transfer");
+}
+
+/* Same as above, with buffers which are only used for this transfer */
+template<typename SrcSpace, typename DstSpace, typename Scalar>
+void transfer(
+	TransferCodec codec, Scalar* dst, const Scalar* src, std::size_t n
+){
+	Buffer<SrcSpace> buf_src;
+	Buffer<DstSpace> buf_dst;
+	transfer<SrcSpace, DstSpace>(codec, dst, src, n, buf_src, buf_dst);
+}
+
+} // namespace detail::codec
+
+} // namespace Kokkidio
+
+#endif
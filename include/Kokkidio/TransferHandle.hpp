@@ -0,0 +1,110 @@
+#ifndef KOKKIDIO_TRANSFERHANDLE_HPP
+#define KOKKIDIO_TRANSFERHANDLE_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/TargetSpaces.hpp"
+#include "Kokkidio/IndexRange.hpp"
+
+#include <Kokkos_Core.hpp>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Returned by asynchronous DualViewMap transfers.
+ * Stores the execution space instance on which the transfer was enqueued.
+ * Any work dispatched on the same instance is ordered after the transfer,
+ * so a TransferHandle can be passed to Kokkidio::parallel_for
+ * to run a kernel once the data has arrived,
+ * without blocking the host in the meantime.
+ *
+ * @tparam _ExecutionSpace
+ */
+template<typename _ExecutionSpace>
+class TransferHandle {
+public:
+	using ExecutionSpace = _ExecutionSpace;
+	static constexpr Target target { spaceToTarget<ExecutionSpace> };
+
+protected:
+	ExecutionSpace m_space;
+
+public:
+	TransferHandle() = default;
+
+	TransferHandle(const ExecutionSpace& space) :
+		m_space {space}
+	{}
+
+	auto space() const -> const ExecutionSpace& {
+		return this->m_space;
+	}
+
+	/**
+	 * @brief Blocks until the transfer
+	 * and all other work enqueued on space() has finished.
+	 */
+	void wait() const {
+		this->m_space.fence("Kokkidio::TransferHandle::wait");
+	}
+
+	/**
+	 * @brief Returns whether all work enqueued on space() has finished,
+	 * without blocking.
+	 * Backends without a non-blocking query fall back to wait().
+	 */
+	bool is_done() const {
+		if constexpr ( target == Target::host ){
+			/* host execution spaces finish deep_copy before returning */
+			return true;
+		} else {
+			#if defined(KOKKIDIO_USE_CUDA)
+			return cudaStreamQuery( this->m_space.cuda_stream() ) == cudaSuccess;
+			#elif defined(KOKKIDIO_USE_HIP)
+			return hipStreamQuery( this->m_space.hip_stream() ) == hipSuccess;
+			#elif defined(KOKKIDIO_USE_SYCL)
+			return this->m_space.sycl_queue().ext_oneapi_empty();
+			#else
+			this->wait();
+			return true;
+			#endif
+		}
+	}
+
+	/**
+	 * @brief Translates an integer, IndexRange, or Kokkos::RangePolicy
+	 * into a Kokkos::RangePolicy on space(),
+	 * so that a kernel dispatched with it is ordered after the transfer.
+	 */
+	template<typename Policy>
+	auto policy( const Policy& pol ) const
+		-> Kokkos::RangePolicy<ExecutionSpace>
+	{
+		auto rng { toIndexRange(pol) };
+		Kokkos::RangePolicy<ExecutionSpace> kpol {
+			this->m_space, rng.begin(), rng.end()
+		};
+		if constexpr ( is_RangePolicy_v<Policy> ){
+			if ( pol.chunk_size() > 0 ){
+				kpol.set_chunk_size( pol.chunk_size() );
+			}
+		}
+		return kpol;
+	}
+};
+
+template<typename T>
+struct is_TransferHandle : std::false_type {};
+
+template<typename ExecutionSpace>
+struct is_TransferHandle<TransferHandle<ExecutionSpace>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_TransferHandle_v = is_TransferHandle<T>::value;
+
+} // namespace Kokkidio
+
+#endif
@@ -10,17 +10,40 @@
 #include "Kokkidio/util.hpp"
 #include "Kokkidio/EigenTypeHelpers.hpp"
 #include "Kokkidio/memory.hpp"
+#include "Kokkidio/CachingAllocator.hpp"
+#include "Kokkidio/firstTouch.hpp"
+#include "Kokkidio/hugePages.hpp"
 #include "Kokkidio/syclify_macros.hpp"
+#include "Kokkidio/macros.hpp"
 
 #include <Kokkos_Core.hpp>
 
 namespace Kokkidio
 {
 
-template<typename _EigenType, Target targetArg = DefaultTarget>
+/**
+ * @brief Wraps an Eigen object's data in a Kokkos::View on @a targetArg,
+ * and provides an Eigen::Map to it.
+ *
+ * @tparam _EigenType
+ * @tparam targetArg
+ * @tparam _hostMemory selects the memory space of allocations on the host,
+ * see HostMemoryPolicy. It has no effect if the target is not the host,
+ * except for HostMemoryPolicy::shared.
+ * With HostMemoryPolicy::hugepages, only memory allocated by the ViewMap
+ * is advised to use huge pages, not a wrapped Eigen object.
+ */
+template<
+	typename _EigenType,
+	Target targetArg = DefaultTarget,
+	HostMemoryPolicy _hostMemory = HostMemoryPolicy::pageable
+>
 class ViewMap {
 public:
 	static constexpr Target target { ExecutionTarget<targetArg> };
+	static constexpr HostMemoryPolicy hostMemory {
+		detail::hostMemoryPolicy<target, _hostMemory>
+	};
 	using EigenType_host = _EigenType;
 	/* To make the ViewMap work, the device view must be non-const in most 
 	 * cases, to not end up with inaccessible device memory.
@@ -33,8 +56,8 @@ public:
 		std::remove_const_t<EigenType_host>
 	>;
 
-	using ThisType = ViewMap<EigenType_target, target>;
-	using MemorySpace    = Kokkidio::MemorySpace   <target>;
+	using ThisType = ViewMap<EigenType_target, target, hostMemory>;
+	using MemorySpace    = Kokkidio::MemorySpace   <target, hostMemory>;
 	using ExecutionSpace = Kokkidio::ExecutionSpace<target>;
 private:
 	using ViewTypeStruct = Kokkidio::detail::ViewType<EigenType_target, MemorySpace>;
@@ -46,13 +69,55 @@ public:
 	#else
 		using HostMirror = typename ViewType::host_mirror_type;
 	#endif
-	using MapType    = Eigen::Map<EigenType_host>;
+	using Layout     = typename ViewType::array_layout;
+	/* Eigen::Map types are mapped with their own stride,
+	 * which requires a Kokkos::LayoutStride View */
+	using PlainObjectType = typename detail::MapTraits<EigenType_host>::PlainObjectType;
+	using StrideType      = typename detail::MapTraits<EigenType_host>::StrideType;
+	static constexpr int MapOptions { detail::MapTraits<EigenType_host>::MapOptions };
+	using MapType    = Eigen::Map<PlainObjectType, MapOptions, StrideType>;
+	using Allocator  = CachingAllocator<MemorySpace, hostMemory>;
+	/* The scalar type of host memory passed to ViewMap(Scalar_host*, ...) */
+	using Scalar_host = transcribe_const_t<
+		EigenType_host, typename std::remove_const_t<EigenType_host>::Scalar
+	>;
 
-	static_assert( is_contiguous<EigenType_target>() );
+	static_assert( has_unit_inner_stride<EigenType_target>() );
+	static constexpr bool IsRowMajor { EigenType_host::IsRowMajor };
+
+	/* Aligned Eigen::Maps with a runtime outer stride
+	 * of at least cache line alignment, e.g. from LayoutPolicy::padded,
+	 * pad the leading dimension of allocations,
+	 * so that every column (row, for row-major types) is aligned */
+	static constexpr bool IsPadded {
+		MapOptions >= Eigen::Aligned64 &&
+		StrideType::OuterStrideAtCompileTime == Eigen::Dynamic
+	};
+	static_assert( !IsPadded ||
+		MapOptions % sizeof( std::remove_const_t<Scalar> ) == 0
+	);
+	/* A single column with the same alignment, see map_col() */
+	using ColMapType = Eigen::Map<
+		transcribe_const_t<PlainObjectType,
+			typename std::remove_const_t<PlainObjectType>::ColXpr::PlainObject
+		>,
+		MapOptions
+	>;
 
 protected:
 	ViewType m_view;
 	observer_ptr<EigenType_host> m_obj {nullptr};
+	/* Set if the View wraps host memory owned by something other than
+	 * an Eigen object, e.g. a MappedFile */
+	bool m_isExternal {false};
+	/* Only allocated when the memory was drawn from the CachingAllocator,
+	 * or when the ViewMap was resized or reserved.
+	 * Holds the reference to the block, while m_view is unmanaged
+	 * and only spans the logical extents. */
+	typename Allocator::BlockType m_block;
+
+	/* Factor by which the capacity grows when resize exceeds it */
+	static constexpr std::size_t growthFactor {2};
 
 public:
 
@@ -91,12 +156,40 @@ public:
 		this->wrapOrAlloc(hostObj);
 	}
 
+	/* Like ViewMap(EigenType_host&), but for raw host memory
+	 * (e.g. from a MappedFile), which must outlive the ViewMap.
+	 * If the target is the host, the View is unmanaged
+	 * and cannot be resized. Otherwise, memory is allocated on the target,
+	 * without copying. */
+	ViewMap( Scalar_host* hostData, Index rows, Index cols ){
+		if constexpr ( target == Target::host ){
+			static_assert( !IsPadded,
+				"Raw host memory has no padding. Use an unpadded type instead."
+			);
+			assert( hostData );
+			this->m_isExternal = true;
+			this->m_view = ViewType{ hostData, makeLayout(rows, cols) };
+		} else {
+			this->allocView(rows, cols);
+		}
+	}
+
+	/* Wraps (part of) an existing allocation, e.g. of a DualViewMapGroup.
+	 * The ViewMap holds a reference to @a block,
+	 * and moves into its own allocation if it is resized beyond it. */
+	ViewMap( const typename Allocator::BlockType& block, Index rows, Index cols ){
+		this->adjustDims(rows, cols);
+		this->m_block = block;
+		this->wrapBlock(rows, cols);
+	}
+
 	/* cannot be called in device code */
 	void resize(Index rows, Index cols){
 		this->adjustDims(rows, cols);
 		if ( rows == this->rows() && cols == this->cols() ){
 			return;
 		}
+		assert( !this->m_isExternal && "Cannot resize external memory!" );
 		if constexpr (
 			!std::is_const_v<EigenType_host> &&
 			!is_eigen_map_v<std::remove_const_t<EigenType_host>>
@@ -122,6 +215,12 @@ public:
 			} else {
 				this->resizeView(rows, cols);
 			}
+		} else
+		if constexpr ( !std::is_const_v<EigenType_host> && IsPadded ){
+			/* Padded types are Eigen::Maps, which can only be resized
+			 * if the ViewMap allocated their memory */
+			assert( this->isManaged() && "Cannot resize a wrapped Eigen::Map!" );
+			this->resizeView(rows, cols);
 		} else {
 			static_assert(dependent_false<EigenType_host>::value && false,
 				"Cannot resize a const or non-owning object!"
@@ -139,14 +238,92 @@ public:
 		this->resize( obj.rows(), obj.cols() );
 	}
 
+	/**
+	 * @brief Ensures that the ViewMap can be resized to \a rows x \a cols
+	 * without reallocating. Does not change rows() or cols().
+	 * 
+	 * Has no effect on a ViewMap which wraps a host object on the host,
+	 * because its memory is owned by that Eigen object,
+	 * nor on fixed size types.
+	 */
+	void reserve(Index rows, Index cols){
+		this->adjustDims(rows, cols);
+		std::size_t newCapacity { storageSize(rows, cols) };
+		if ( !this->isManaged() ||
+			newCapacity <= static_cast<std::size_t>( this->capacity() )
+		){
+			return;
+		}
+		this->reallocBlock( newCapacity, this->rows(), this->cols() );
+	}
+
+	void reserve(Index size){
+		static_assert( EigenType_host::IsVectorAtCompileTime );
+		this->reserve(size, size);
+	}
+
+	/**
+	 * @brief Returns the number of elements
+	 * which the ViewMap can hold without reallocating.
+	 * Resizing within the capacity only changes the logical extents
+	 * reported by rows(), cols(), map() and view(). 
+	 * In that case, values are kept at their indices 
+	 * as long as the number of rows (columns for row-major types)
+	 * does not change.
+	 * Host only, like reserve() and resize().
+	 */
+	Index capacity() const {
+		using S = std::remove_const_t<Scalar>;
+		if ( this->m_block.is_allocated() ){
+			return static_cast<Index>( this->m_block.extent(0) / sizeof(S) );
+		}
+		if constexpr (IsPadded){
+			return static_cast<Index>( storageSize( this->rows(), this->cols() ) );
+		} else {
+			return this->size();
+		}
+	}
+
+	/**
+	 * @brief On Target::host, sets the managed memory to zero in parallel,
+	 * so that each thread's part of the data, as given by
+	 * ParallelRange<Target::host>, is placed on that thread's NUMA node.
+	 * Column vectors are partitioned by rows, other types by columns
+	 * (rows for row-major types).
+	 *
+	 * Called automatically on allocation, if enableFirstTouch() was called.
+	 * Has no effect on the device, or if the ViewMap wraps a host object.
+	 */
+	void firstTouch(){
+		if constexpr ( target == Target::host ){
+			if ( !this->isManaged() || !this->isAlloc() ){
+				return;
+			}
+			using S = std::remove_const_t<Scalar>;
+			/* Memory allocated by a ViewMap is contiguous, except for padding */
+			S* data { const_cast<S*>( this->m_view.data() ) };
+			if constexpr ( EigenType_host::IsVectorAtCompileTime ){
+				detail::firstTouch( data, this->size(), 1, 1 );
+			} else if constexpr (IsRowMajor){
+				detail::firstTouch( data,
+					this->rows(), this->cols(), this->outerStride()
+				);
+			} else {
+				detail::firstTouch( data,
+					this->cols(), this->rows(), this->outerStride()
+				);
+			}
+		}
+	}
+
 	KOKKOS_FUNCTION
 	constexpr bool isManaged() const {
 		/* The View is only unmanaged in one case:
-		 * if a host object was provided during construction AND
-		 * the target (~= ExecutionSpace) is also the host.
+		 * if a host object or host memory was provided during construction
+		 * AND the target (~= ExecutionSpace) is also the host.
 		 * A device View is always managed, 
 		 * and so is a host View that doesn't wrap a host object. */
-		return !(target == Target::host && m_obj);
+		return !(target == Target::host && (m_obj || m_isExternal));
 	}
 
 protected:
@@ -171,16 +348,70 @@ protected:
 		this->adjustCols(cols);
 	}
 
+	/* The distance between columns (rows, for row-major types)
+	 * in memory allocated by a ViewMap */
+	static constexpr Index paddedStride(Index rows, Index cols){
+		Index inner { IsRowMajor ? cols : rows };
+		if constexpr (IsPadded){
+			constexpr Index n {
+				MapOptions / static_cast<Index>( sizeof( std::remove_const_t<Scalar> ) )
+			};
+			return (inner + n - 1) / n * n;
+		} else {
+			return inner;
+		}
+	}
+
+	/* The number of elements, including padding,
+	 * which an allocation of rows x cols requires */
+	static std::size_t storageSize(Index rows, Index cols){
+		return static_cast<std::size_t>(
+			paddedStride(rows, cols) * ( IsRowMajor ? rows : cols )
+		);
+	}
+
+	/* For LayoutStride, an outerStride of zero means the storage
+	 * which is used for all Views allocated by a ViewMap,
+	 * i.e. contiguous, or padded, if IsPadded is set. */
+	static auto makeLayout(Index rows, Index cols, Index outerStride = 0)
+		-> Layout
+	{
+		std::size_t
+			r { static_cast<std::size_t>(rows) },
+			c { static_cast<std::size_t>(cols) };
+		if constexpr ( std::is_same_v<Layout, Kokkos::LayoutStride> ){
+			std::size_t s { static_cast<std::size_t>( outerStride > 0 ?
+				outerStride : paddedStride(rows, cols)
+			) };
+			if constexpr (IsRowMajor){
+				return Layout(r, s, c, 1);
+			} else {
+				return Layout(r, 1, c, s);
+			}
+		} else {
+			return Layout(r, c);
+		}
+	}
+
 	void allocView(Index rows, Index cols){
 		this->adjustDims(rows, cols);
-		this->m_view = ViewType{
-			Kokkos::view_alloc(
-				MemorySpace{}, Kokkos::WithoutInitializing,
-				"ViewMap::allocView"
-			),
-			static_cast<std::size_t>(rows),
-			static_cast<std::size_t>(cols)
-		};
+		if ( Allocator::get().isEnabled() ){
+			this->m_block = this->allocBlock( storageSize(rows, cols) );
+			this->wrapBlock(rows, cols);
+		} else {
+			this->m_block = {};
+			this->m_view = ViewType{
+				Kokkos::view_alloc(
+					MemorySpace{}, Kokkos::WithoutInitializing,
+					"ViewMap::allocView"
+				),
+				makeLayout(rows, cols)
+			};
+		}
+		this->adviseHugePages();
+		if ( isFirstTouchEnabled() ){
+			this->firstTouch();
+		}
 		printd( "(%p) Allocating View, on %cPU, size %i x %i.\n"
 			, (void*) this->m_view.data()
 			, target == Target::host ? 'C' : 'G'
@@ -198,19 +429,116 @@ protected:
 		assert( this->isAlloc() );
 	}
 
+	/* With HostMemoryPolicy::hugepages, requests huge pages
+	 * for the whole allocation, before it is first written to. */
+	void adviseHugePages(){
+		if constexpr ( hostMemory == HostMemoryPolicy::hugepages ){
+			using S = std::remove_const_t<Scalar>;
+			if ( this->m_block.is_allocated() ){
+				detail::adviseHugePages(
+					this->m_block.data(), this->m_block.extent(0)
+				);
+			} else {
+				detail::adviseHugePages(
+					const_cast<S*>( this->m_view.data() ),
+					this->m_view.span() * sizeof(S)
+				);
+			}
+		}
+	}
+
+	/* Returns a block with room for at least nElems elements,
+	 * drawn from the CachingAllocator if it is enabled. */
+	auto allocBlock(std::size_t nElems) const -> typename Allocator::BlockType {
+		using S = std::remove_const_t<Scalar>;
+		std::size_t bytes { sizeof(S) * nElems };
+		if ( Allocator::get().isEnabled() ){
+			return Allocator::get().allocate(bytes);
+		}
+		return {
+			Kokkos::view_alloc(
+				MemorySpace{}, Kokkos::WithoutInitializing,
+				"ViewMap::allocBlock"
+			),
+			bytes
+		};
+	}
+
+	/* Sets the logical extents by wrapping an unmanaged View around m_block */
+	void wrapBlock(Index rows, Index cols){
+		using S = std::remove_const_t<Scalar>;
+		assert( this->m_block.is_allocated() );
+		assert( storageSize(rows, cols) * sizeof(S) <= this->m_block.extent(0) );
+		this->m_view = ViewType{
+			reinterpret_cast<S*>( this->m_block.data() ),
+			makeLayout(rows, cols)
+		};
+		printd( "(%p) Wrapping View around block, on %cPU, size %i x %i.\n"
+			, (void*) this->m_view.data()
+			, target == Target::host ? 'C' : 'G'
+			, static_cast<int>( this->rows() )
+			, static_cast<int>( this->cols() )
+		);
+	}
+
+	/* Moves the data into a new block with room for nElems elements,
+	 * and sets the logical extents to rows x cols.
+	 * Like Kokkos::resize, this preserves the overlapping data.
+	 * The old View stays valid until the copy is done,
+	 * because oldBlock keeps its memory from being reused. */
+	void reallocBlock(std::size_t nElems, Index rows, Index cols){
+		ViewType oldView { this->m_view };
+		auto oldBlock { this->m_block };
+		this->m_block = this->allocBlock(nElems);
+		this->wrapBlock(rows, cols);
+		this->adviseHugePages();
+		/* The copy below does not follow the ompSegment partition,
+		 * so the pages must be placed before it. */
+		if ( isFirstTouchEnabled() ){
+			this->firstTouch();
+		}
+		if ( oldView.is_allocated() ){
+			auto overlap = [&](std::size_t oldExtent, Index newExtent){
+				return Kokkos::make_pair( std::size_t{0}, std::min(
+					oldExtent, static_cast<std::size_t>(newExtent)
+				) );
+			};
+			auto r { overlap(oldView.extent(0), rows) };
+			auto c { overlap(oldView.extent(1), cols) };
+			Kokkos::deep_copy(
+				Kokkos::subview(this->m_view, r, c),
+				Kokkos::subview(oldView, r, c)
+			);
+		}
+	}
+
 	void resizeView(Index rows, Index cols){
 		assert( this->isManaged() );
 		// adjustDims(rows, cols);
 		if ( rows == this->rows() && cols == this->cols() ){
 			return;
 		}
-		Kokkos::resize(
-			Kokkos::WithoutInitializing,
-			this->m_view,
-			static_cast<std::size_t>(rows),
-			static_cast<std::size_t>(cols)
+		std::size_t
+			newSize { storageSize(rows, cols) },
+			oldCapacity { static_cast<std::size_t>( this->capacity() ) };
+		if ( newSize > oldCapacity ){
+			/* grow geometrically, so that repeated growth
+			 * only reallocates a logarithmic number of times */
+			this->reallocBlock(
+				std::max( newSize, growthFactor * oldCapacity ), rows, cols
+			);
+		} else if ( !this->m_block.is_allocated() ){
+			/* An exactly sized View owns its memory itself,
+			 * so it cannot be narrowed without losing the allocation.
+			 * Moving it into a block once makes later resizes free. */
+			this->reallocBlock(oldCapacity, rows, cols);
+		} else {
+			/* Within capacity, only the logical extents change */
+			this->wrapBlock(rows, cols);
+		}
+		printd( "(%p) Setting view size to %i, capacity %i.\n"
+			, (void*) this, this->size(), this->capacity()
 		);
-		printd( "(%p) Setting view size to %i.\n", (void*) this, this->size() );
 	}
 
 	void wrapView(EigenType_host& hostObj ){
@@ -221,9 +549,9 @@ protected:
 			, static_cast<int>( hostObj.rows() )
 			, static_cast<int>( hostObj.cols() )
 		);
+		this->m_block = {};
 		this->m_view = ViewType{ hostObj.data(),
-			static_cast<std::size_t>( hostObj.rows() ),
-			static_cast<std::size_t>( hostObj.cols() )
+			makeLayout( hostObj.rows(), hostObj.cols(), hostObj.outerStride() )
 		};
 		printd( "(%p) View now has size %i x %i.\n"
 			, (void*) this->view().data()
@@ -262,6 +590,19 @@ public:
 		return this->m_view.is_allocated();
 	}
 
+	/**
+	 * @brief If the memory was drawn from the CachingAllocator,
+	 * records that work on it was enqueued on @a space,
+	 * so that only that instance is fenced before the memory is reused.
+	 * Host only.
+	 */
+	template<typename ExecSpace>
+	void recordUse(const ExecSpace& space) const {
+		if ( this->m_block.is_allocated() ){
+			Allocator::get().recordUse(this->m_block, space);
+		}
+	}
+
 	// KOKKOS_FUNCTION
 	// Scalar* data() {
 	// 	assert( this->isAlloc() );
@@ -296,18 +637,66 @@ public:
 		 * and thus a copy-capturing lambda will capture this class'
 		 * 'this' pointer as const.
 		 * */
+		#ifdef KOKKIDIO_MAP_CHECKS
+		if ( !this->m_view.is_allocated() ){
+			printd( "(%p) View not allocated, on %cPU, size %i x %i.\n"
+				, (void*) this->m_view.data()
+				, target == Target::host ? 'C' : 'G'
+				, static_cast<int>( this->rows() )
+				, static_cast<int>( this->cols() )
+			);
+		}
+		#endif
+		return this->map_unchecked();
+	}
 
-			// if ( !this->isAlloc() ){
-			if ( !this->m_view.is_allocated() ){
-				printd( "(%p) View not allocated, on %cPU, size %i x %i.\n"
-					, (void*) this->m_view.data()
-					, target == Target::host ? 'C' : 'G'
-					, static_cast<int>( this->rows() )
-					, static_cast<int>( this->cols() )
-				);
+	/**
+	 * @brief Same as map(), but never checks whether the View is allocated,
+	 * regardless of KOKKIDIO_MAP_CHECKS.
+	 * For use in the innermost loops of a kernel.
+	 * To avoid even reading the extents from the View on each iteration,
+	 * call map() once outside of the kernel, and capture the Eigen::Map.
+	 */
+	KOKKOS_FUNCTION
+	auto map_unchecked() const -> MapType {
+		if constexpr ( has_outer_stride_v<EigenType_host> ){
+			if constexpr ( std::is_constructible_v<StrideType, Index> ){
+				return { this->m_view.data(), this->rows(), this->cols(),
+					StrideType{ this->outerStride() }
+				};
+			} else {
+				return { this->m_view.data(), this->rows(), this->cols(),
+					StrideType{ this->outerStride(), 1 }
+				};
 			}
-		// assert( this->isAlloc() );
-		return { this->m_view.data(), this->rows(), this->cols() };
+		} else {
+			return { this->m_view.data(), this->rows(), this->cols() };
+		}
+	}
+
+	/**
+	 * @brief For padded column-major types (see IsPadded),
+	 * maps the columns [start, start + n) with the alignment of map().
+	 * Eigen cannot know that the columns of a block of map(),
+	 * e.g. map().middleCols(start, n), are aligned,
+	 * because the outer stride is only known at runtime.
+	 * Kokkidio::colRange and ParallelRange use this for padded ViewMaps.
+	 */
+	KOKKOS_FUNCTION
+	auto map_cols(Index start, Index n) const -> MapType {
+		static_assert( IsPadded && !IsRowMajor );
+		assert( start >= 0 && start + n <= this->cols() );
+		return { this->m_view.data() + start * this->outerStride(),
+			this->rows(), n, StrideType{ this->outerStride() }
+		};
+	}
+
+	/* Same as map_cols(), for a single column */
+	KOKKOS_FUNCTION
+	auto map_col(Index j) const -> ColMapType {
+		static_assert( IsPadded && !IsRowMajor );
+		assert( j >= 0 && j < this->cols() );
+		return { this->m_view.data() + j * this->outerStride(), this->rows() };
 	}
 
 	/**
@@ -339,6 +728,16 @@ public:
 	Index size() const {
 		return static_cast<Index>( this->m_view.size() );
 	}
+
+	/* Like Eigen's outerStride(): 
+	 * the distance between columns (or rows, for row-major types). */
+	KOKKOS_FUNCTION
+	Index outerStride() const {
+		return static_cast<Index>( IsRowMajor ?
+			this->m_view.stride_0() :
+			this->m_view.stride_1()
+		);
+	}
 };
 
 // static_assert( std::is_trivially_copyable_v<ViewMap<ArrayXXs, Target::device>> );
@@ -346,8 +745,8 @@ public:
 template<typename T>
 struct is_ViewMap : std::false_type {};
 
-template<typename EigenType, Target target>
-struct is_ViewMap<ViewMap<EigenType, target>> : std::true_type {};
+template<typename EigenType, Target target, HostMemoryPolicy hostMemory>
+struct is_ViewMap<ViewMap<EigenType, target, hostMemory>> : std::true_type {};
 
 template<typename T>
 inline constexpr bool is_ViewMap_v = is_ViewMap<T>::value;
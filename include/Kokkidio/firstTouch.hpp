@@ -0,0 +1,95 @@
+#ifndef KOKKIDIO_FIRSTTOUCH_HPP
+#define KOKKIDIO_FIRSTTOUCH_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/hostThreads.hpp"
+#include "Kokkidio/typeAliases.hpp"
+#include "Kokkidio/macros.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Kokkidio
+{
+
+namespace detail
+{
+
+inline std::atomic<bool>& firstTouchFlag(){
+	static std::atomic<bool> flag {false};
+	return flag;
+}
+
+} // namespace detail
+
+/**
+ * @brief With first-touch enabled, ViewMaps on Target::host write to
+ * newly allocated memory in parallel, using the same ompSegment partition
+ * as ParallelRange<Target::host>.
+ *
+ * Memory pages are placed on the NUMA node of the thread
+ * which first writes to them. Without this, that is usually
+ * the main thread copying in data, so that all pages end up on one node.
+ * With first-touch, each thread's part of the data lives on its own node,
+ * as long as the threads are pinned (e.g. OMP_PROC_BIND=spread).
+ *
+ * Disabled by default, because it initialises memory
+ * which would otherwise be left uninitialised.
+ */
+inline void enableFirstTouch(bool arg = true){
+	detail::firstTouchFlag() = arg;
+}
+
+inline void disableFirstTouch(){
+	enableFirstTouch(false);
+}
+
+inline bool isFirstTouchEnabled(){
+	return detail::firstTouchFlag();
+}
+
+namespace detail
+{
+
+/* Sets @a nOuter segments of @a nInner elements each to zero,
+ * which start @a stride elements apart,
+ * with each OpenMP thread (or ThreadPool worker) writing the segments
+ * that ParallelRange<Target::host> later assigns to it.
+ * Padding between the segments is written as well. */
+template<typename Scalar>
+void firstTouch( Scalar* data, Index nOuter, Index nInner, Index stride ){
+	printd( "(%p) First-touching %i x %i elements.\n"
+		, (void*) data
+		, static_cast<int>(nInner)
+		, static_cast<int>(nOuter)
+	);
+	auto touch = [&](const IndexRange<Index>& seg){
+		if ( seg.size() > 0 ){
+			std::fill_n( data + seg.start() * stride,
+				(seg.size() - 1) * stride + nInner, Scalar{}
+			);
+		}
+	};
+	#ifdef KOKKIDIO_HOST_THREADPOOL
+	/* one piece per worker, which starts out in that worker's own deque,
+	 * in the same order as the pieces of a kernel over nOuter */
+	const Index nThreads { host::maxThreads() };
+	host::forEachPiece(
+		IndexRange<Index>{0, nOuter}, (nOuter + nThreads - 1) / nThreads, touch
+	);
+	#else
+	KOKKIDIO_OMP_PRAGMA(parallel)
+	{
+		touch( ompSegment( IndexRange<Index>{0, nOuter} ) );
+	}
+	#endif
+}
+
+} // namespace detail
+
+} // namespace Kokkidio
+
+#endif
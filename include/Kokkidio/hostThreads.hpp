@@ -0,0 +1,82 @@
+#ifndef KOKKIDIO_HOSTTHREADS_HPP
+#define KOKKIDIO_HOSTTHREADS_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/ompSegment.hpp"
+#include "Kokkidio/typeAliases.hpp"
+#include "Kokkidio/macros.hpp"
+
+#ifdef KOKKIDIO_HOST_THREADPOOL
+#include "Kokkidio/ThreadPool.hpp"
+#endif
+
+#include <algorithm>
+
+/**
+ * Thread queries for the host backend, which is either OpenMP,
+ * or, with KOKKIDIO_HOST_THREADPOOL, the Kokkidio::ThreadPool.
+ */
+namespace Kokkidio::detail::host
+{
+
+/* The number of threads which may run host kernels */
+inline int maxThreads(){
+	#if defined(KOKKIDIO_HOST_THREADPOOL)
+	return ThreadPool::instance().size();
+	#elif defined(KOKKIDIO_OPENMP)
+	return omp_get_max_threads();
+	#else
+	return 1;
+	#endif
+}
+
+/* The index of the calling thread in [0, maxThreads()),
+ * which is the worker index with the ThreadPool */
+inline int threadNum(){
+	#if defined(KOKKIDIO_HOST_THREADPOOL)
+	return std::max( 0, ThreadPool::workerIndex() );
+	#elif defined(KOKKIDIO_OPENMP)
+	return omp_get_thread_num();
+	#else
+	return 0;
+	#endif
+}
+
+/* Whether the caller runs inside a host kernel */
+inline bool inParallel(){
+	#if defined(KOKKIDIO_HOST_THREADPOOL)
+	return ThreadPool::workerIndex() >= 0;
+	#elif defined(KOKKIDIO_OPENMP)
+	return omp_in_parallel();
+	#else
+	return false;
+	#endif
+}
+
+#ifdef KOKKIDIO_HOST_THREADPOOL
+/* Without a chunk size, each worker gets about eight pieces */
+inline Index poolPieceSize( Index n ){
+	return std::max<Index>( 1, n / ( 8 * maxThreads() ) );
+}
+
+/**
+ * @brief Calls @a func for the pieces of @a range on the ThreadPool,
+ * and returns once all of them are done.
+ */
+template<typename Func>
+void forEachPiece( const IndexRange<Index>& range, Index chunk, const Func& func ){
+	ThreadPool::instance().forEachPiece(range, chunk, func);
+}
+
+template<typename Func>
+void forEachPiece( const IndexRange<Index>& range, const Func& func ){
+	forEachPiece( range, poolPieceSize( range.size() ), func );
+}
+#endif
+
+} // namespace Kokkidio::detail::host
+
+#endif
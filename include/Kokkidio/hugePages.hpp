@@ -0,0 +1,63 @@
+#ifndef KOKKIDIO_HUGEPAGES_HPP
+#define KOKKIDIO_HUGEPAGES_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/macros.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace Kokkidio::detail
+{
+
+/* Size of a transparent huge page on x86-64 and most aarch64 systems */
+inline constexpr std::size_t hugePageSize { std::size_t{2} << 20 };
+
+/**
+ * @brief Asks the kernel to back the memory in [data, data + bytes)
+ * with transparent huge pages, via madvise(MADV_HUGEPAGE).
+ * Only the huge-page aligned part of the range can be advised,
+ * so small allocations are left unchanged.
+ * This must happen before the memory is first written to.
+ *
+ * Returns the number of advised bytes, which is zero
+ * if the range contains no aligned huge page, if the system does not
+ * support transparent huge pages, or if they are disabled.
+ * In all of these cases, the memory stays usable with regular pages.
+ */
+inline std::size_t adviseHugePages( void* data, std::size_t bytes ){
+	#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	auto addr { reinterpret_cast<std::uintptr_t>(data) };
+	std::uintptr_t
+		beg { (addr + hugePageSize - 1) / hugePageSize * hugePageSize },
+		end { (addr + bytes) / hugePageSize * hugePageSize };
+	if ( !data || end <= beg ){
+		return 0;
+	}
+	if ( madvise( reinterpret_cast<void*>(beg), end - beg, MADV_HUGEPAGE ) != 0 ){
+		printd( "(%p) madvise(MADV_HUGEPAGE) failed, using regular pages.\n"
+			, data
+		);
+		return 0;
+	}
+	printd( "(%p) Advised %zu of %zu bytes to use huge pages.\n"
+		, data, static_cast<std::size_t>(end - beg), bytes
+	);
+	return end - beg;
+	#else
+	(void) data;
+	(void) bytes;
+	return 0;
+	#endif
+}
+
+} // namespace Kokkidio::detail
+
+#endif
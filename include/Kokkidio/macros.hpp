@@ -55,6 +55,16 @@
 #define printd(...)
 #endif
 
+/* ViewMap::map() and DualViewMap::map_target()/map_host() check whether
+ * the View is allocated and report it via printd.
+ * The check is only compiled in with KOKKIDIO_DEBUG_OUTPUT,
+ * and defining KOKKIDIO_NO_MAP_CHECKS strips it even then. */
+// #define KOKKIDIO_NO_MAP_CHECKS
+
+#if defined(KOKKIDIO_DEBUG_OUTPUT) && !defined(KOKKIDIO_NO_MAP_CHECKS)
+#define KOKKIDIO_MAP_CHECKS
+#endif
+
 
 
 /* forces the compiler to inline a function */
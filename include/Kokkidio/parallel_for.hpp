@@ -6,6 +6,8 @@
 #endif
 
 #include "Kokkidio/ParallelRange.hpp"
+#include "Kokkidio/TransferHandle.hpp"
+#include "Kokkidio/HostSchedule.hpp"
 
 namespace Kokkidio
 {
@@ -28,12 +30,39 @@ template<typename Policy, typename Func>
 void parallel_for_host(const Policy& pol, Func&& func){
 	printd("Redirected Kokkidio::parallel_for to parallel_for_host.\n");
 	auto range { toIndexRange(pol) };
+	#ifdef KOKKIDIO_HOST_THREADPOOL
+	host::forEachPiece( IndexRange<Index>{ range.start(), range.size() },
+		[&](const IndexRange<Index>& piece){
+			for (int i = piece.start(); i < piece.end(); ++i){
+				func(i);
+			}
+		}
+	);
+	#else
 	KOKKIDIO_OMP_PRAGMA(parallel for)
 	for (int i=range.start(); i<range.end(); ++i){
 		func(i);
 	}
+	#endif
 }
 
+#ifdef KOKKIDIO_HOST_THREADPOOL
+/* Runs @a func on the ThreadPool, with a ParallelRange for each piece */
+template<typename Policy, typename Func>
+void forEachPoolRange( const Policy& pol, Func&& func ){
+	Index chunkSizeMax { chunk::defaultSize };
+	if constexpr ( is_RangePolicy_v<Policy> ){
+		chunkSizeMax = pol.chunk_size();
+	}
+	auto range { toIndexRange(pol) };
+	host::forEachPiece( IndexRange<Index>{ range.start(), range.size() },
+		[&](const IndexRange<Index>& piece){
+			func( ParallelRange<Target::host>::fromPiece(piece, chunkSizeMax) );
+		}
+	);
+}
+#endif
+
 template<Target target, typename Policy, typename Func>
 void parallel_for( const Policy& pol, Func&& func ){
 	using T = Target;
@@ -70,6 +99,10 @@ void parallel_for_range(
 	// }
 
 	if constexpr (target == T::host){
+		#ifdef KOKKIDIO_HOST_THREADPOOL
+		/* The ThreadPool calls func once per non-empty piece */
+		detail::forEachPoolRange( pol, func );
+		#else
 		KOKKIDIO_OMP_PRAGMA(parallel)
 		{
 			/* we could place a condition here to only call the function,
@@ -79,6 +112,7 @@ void parallel_for_range(
 			 * from working, which seems to be a much bigger downside. */
 			func( ParallelRange<T::host>{pol} );
 		}
+		#endif
 	} else
 	if constexpr (target == T::device){
 		/* Additional indirection via lambda is needed,
@@ -94,6 +128,35 @@ void parallel_for_range(
 }
 
 
+/**
+ * @brief Same as parallel_for_range(pol, func), except that on the host,
+ * the range is distributed among the threads according to @a sched,
+ * and @a func is called once per piece, see HostSchedule.
+ */
+template<Target target = DefaultTarget, typename Policy, typename Func>
+void parallel_for_range(
+	const HostSchedule& sched,
+	const Policy& pol,
+	Func&& func
+){
+	if constexpr (target == Target::host){
+		static_assert( detail::is_range_target_invocable<Func, target> );
+		Index chunkSizeMax { chunk::defaultSize };
+		if constexpr ( is_RangePolicy_v<Policy> ){
+			chunkSizeMax = pol.chunk_size();
+		}
+		auto range { toIndexRange(pol) };
+		detail::schedule::forEachPiece( sched,
+			IndexRange<Index>{ range.start(), range.size() },
+			[&](const IndexRange<Index>& piece){
+				func( ParallelRange<target>::fromPiece(piece, chunkSizeMax) );
+			}
+		);
+	} else {
+		parallel_for_range<target>( pol, std::forward<Func>(func) );
+	}
+}
+
 template<Target target = DefaultTarget, typename Policy, typename Func>
 void parallel_for( const Policy& pol, Func&& func ){
 	if constexpr ( detail::is_range_invocable<Func> ){
@@ -103,16 +166,81 @@ void parallel_for( const Policy& pol, Func&& func ){
 	}
 }
 
+/**
+ * @brief Same as parallel_for(pol, func), except that on the host,
+ * the range is distributed among the threads according to @a sched,
+ * see HostSchedule.
+ */
+template<Target target = DefaultTarget, typename Policy, typename Func>
+void parallel_for(
+	const HostSchedule& sched,
+	const Policy& pol,
+	Func&& func
+){
+	if constexpr ( detail::is_range_invocable<Func> ){
+		parallel_for_range<target>( sched, pol, std::forward<Func>(func) );
+	} else {
+		#if defined(KOKKIDIO_USE_SYCL) && !defined(KOKKIDIO_SYCL_DISABLE_ON_HOST)
+		constexpr bool onHost {false};
+		#else
+		constexpr bool onHost { target == Target::host };
+		#endif
+		if constexpr (onHost){
+			auto range { toIndexRange(pol) };
+			detail::schedule::forEachPiece( sched,
+				IndexRange<Index>{ range.start(), range.size() },
+				[&](const IndexRange<Index>& piece){
+					for (int i = piece.start(); i < piece.end(); ++i){
+						func(i);
+					}
+				}
+			);
+		} else {
+			detail::parallel_for<target>( pol, std::forward<Func>(func) );
+		}
+	}
+}
+
+/**
+ * @brief Dispatches @a func once the transfer behind @a handle has finished.
+ * If both the kernel and the transfer run on the device,
+ * the kernel is enqueued on the same execution space instance,
+ * so neither the transfer nor the dispatch block the host.
+ * Otherwise, this waits for the transfer before dispatching.
+ */
+template<Target target = DefaultTarget, typename Space, typename Policy, typename Func>
+void parallel_for(
+	const TransferHandle<Space>& handle,
+	const Policy& pol,
+	Func&& func
+){
+	if constexpr (
+		target == Target::device &&
+		TransferHandle<Space>::target == Target::device
+	){
+		parallel_for<target>( handle.policy(pol), std::forward<Func>(func) );
+	} else {
+		handle.wait();
+		parallel_for<target>( pol, std::forward<Func>(func) );
+	}
+}
+
 template<Target target = DefaultTarget, typename Policy, typename Func>
 // KOKKIDIO_INLINE 
 void parallel_for_chunks(const Policy& pol, Func&& func){
 
 	if constexpr ( target == Target::host ){
+		#ifdef KOKKIDIO_HOST_THREADPOOL
+		detail::forEachPoolRange( pol, [&](const ParallelRange<target>& rng){
+			rng.for_each_chunk(func);
+		});
+		#else
 		KOKKIDIO_OMP_PRAGMA(parallel)
 		{
 			ParallelRange<target> rng {pol};
 			rng.for_each_chunk( std::forward<Func>(func) );
 		}
+		#endif
 	} else {
 		static_assert( target == Target::device );
 		static_assert( std::is_invocable_v<Func, EigenRange<target>> );
@@ -7,6 +7,9 @@
 
 #include "Kokkidio/ParallelRange.hpp"
 #include "Kokkidio/RangePolicyHelper.hpp"
+#include "Kokkidio/parallel_for.hpp"
+
+#include <vector>
 
 
 namespace Kokkidio
@@ -61,12 +64,30 @@ template<typename Policy, typename Func, typename Reducer>
 void reduce_host( const Policy& pol, Func&& func, const Reducer& reducer ){
 
 	using Scalar = typename Reducer::value_type;
+	Scalar var;
+	reducer.init(var);
+
+	#ifdef KOKKIDIO_HOST_THREADPOOL
+	/* one partial result per worker, each on its own cache line,
+	 * joined after all pieces are done */
+	struct alignas(64) Partial {
+		Scalar value;
+	};
+	std::vector<Partial> partials ( detail::host::maxThreads() );
+	for (Partial& partial : partials){
+		reducer.init(partial.value);
+	}
+	detail::forEachPoolRange( pol, [&](const ParallelRange<Target::host>& rng){
+		func( rng, partials[ detail::host::threadNum() ].value );
+	});
+	for (const Partial& partial : partials){
+		reducer.join(var, partial.value);
+	}
+	#else
 	/* Somehow, nvcc doesn't resolve ExecutionSpace<Target::host> 
 	 * to the underlying type */
 	using Space = typename detail::ExecutionSpace<Target::host>::Type;
 	// using Space = ExecutionSpace<Target::host>;
-	Scalar var;
-	reducer.init(var);
 
 	#define KOKKIDIO_REDUCE_IF(NAME) \
 		if constexpr ( std::is_same_v<Reducer, Kokkos::NAME<Scalar, Space>> )
@@ -92,6 +113,7 @@ void reduce_host( const Policy& pol, Func&& func, const Reducer& reducer ){
 
 	#undef KOKKIDIO_REDUCE_BODY
 	#undef KOKKIDIO_REDUCE_IF
+	#endif
 
 	reducer.reference() = var;
 }
@@ -0,0 +1,555 @@
+#ifndef KOKKIDIO_PARALLEL_TEAM_HPP
+#define KOKKIDIO_PARALLEL_TEAM_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/ParallelRange.hpp"
+#include "Kokkidio/HostSchedule.hpp"
+#include "Kokkidio/parallel_for.hpp"
+#include "Kokkidio/parallel_reduce.hpp"
+
+#include <cassert>
+#include <vector>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Configuration of parallel_for_team and parallel_reduce_team.
+ * @a leagueSize teams are dispatched,
+ * each with @a scratchBytes of team scratch memory,
+ * which is the sum of teamScratchSize over all buffers of a team.
+ * On the device, each team has @a teamSize threads
+ * (zero selects Kokkos::AUTO) with @a vectorLength vector lanes each.
+ * On the host, each team consists of a single thread,
+ * so these two are ignored.
+ */
+struct TeamConfig {
+	Index leagueSize {0};
+	std::size_t scratchBytes {0};
+	int teamSize {0};
+	int vectorLength {1};
+};
+
+namespace teamScratch
+{
+
+/* Each scratch buffer of a team starts at a multiple of this many bytes */
+inline constexpr std::size_t alignment {16};
+
+} // namespace teamScratch
+
+/**
+ * @brief Returns the number of bytes of team scratch memory
+ * which TeamHandle::scratch<PlainObjectType>(rows, cols) takes up.
+ */
+template<typename PlainObjectType>
+KOKKOS_FUNCTION
+constexpr std::size_t teamScratchSize( Index rows, Index cols = 1 ){
+	using Scalar = typename PlainObjectType::Scalar;
+	constexpr std::size_t a {teamScratch::alignment};
+	const std::size_t bytes { static_cast<std::size_t>(rows * cols) * sizeof(Scalar) };
+	return (bytes + a - 1) / a * a;
+}
+
+namespace detail
+{
+
+/* On the host, a team is a single thread, which only knows its league rank */
+struct HostTeamMember {
+	Index leagueRank;
+	Index leagueSize;
+};
+
+template<Target target>
+struct TeamMemberHelper {
+	using Type = typename Kokkos::TeamPolicy<ExecutionSpace<target>>::member_type;
+};
+
+template<>
+struct TeamMemberHelper<Target::host> {
+	using Type = HostTeamMember;
+};
+
+} // namespace detail
+
+template<Target target>
+using TeamMember = typename detail::TeamMemberHelper<target>::Type;
+
+
+/**
+ * @brief The argument of functors passed to parallel_for_team
+ * and parallel_reduce_team, which refers to one team.
+ *
+ * Its member functions parallel_for and parallel_reduce
+ * distribute a range among the threads of the team,
+ * vector_for and vector_reduce among the vector lanes of one thread.
+ * Like Kokkidio::parallel_for, they accept functors
+ * taking either an index, or a ParallelRange<target>.
+ * On the host, each of them processes the whole range on the calling thread,
+ * so that a ParallelRange covers the whole range,
+ * and can be used for Eigen expressions and chunks.
+ *
+ * Every thread of a team must call scratch in the same order,
+ * to get the same buffers.
+ */
+template<Target _target = DefaultTarget>
+class TeamHandle {
+public:
+	static constexpr Target target {_target};
+	static constexpr bool isDevice {target == Target::device};
+	static constexpr bool isHost   {target == Target::host};
+	using MemberType = TeamMember<target>;
+
+protected:
+	const MemberType* m_member {nullptr};
+	char* m_scratch {nullptr};
+	std::size_t m_scratchSize {0};
+	/* mutable, like Kokkos' scratch memory space,
+	 * so that buffers can be taken from a const TeamHandle& */
+	mutable std::size_t m_scratchUsed {0};
+
+	template<typename Func>
+	KOKKOS_FUNCTION
+	static void callIndex( Func& func, int i ){
+		if constexpr ( detail::is_range_invocable<Func> ){
+			func( ParallelRange<target>{i} );
+		} else {
+			func(i);
+		}
+	}
+
+	template<typename Func, typename Scalar>
+	KOKKOS_FUNCTION
+	static void callIndex( Func& func, int i, Scalar& var ){
+		if constexpr ( detail::is_range_invocable_redux<Func, Scalar&> ){
+			func( ParallelRange<target>{i}, var );
+		} else {
+			func(i, var);
+		}
+	}
+
+	/* On the host, the team's only thread processes the whole range */
+	template<typename Func>
+	static void callHost( const IndexRange<Index>& rng, Func& func ){
+		if constexpr ( detail::is_range_invocable<Func> ){
+			func( ParallelRange<Target::host>::fromPiece(rng) );
+		} else {
+			for ( Index i {rng.start()}; i < rng.end(); ++i ){
+				func( static_cast<int>(i) );
+			}
+		}
+	}
+
+	template<typename Func, typename Reducer>
+	static void reduceHost( const IndexRange<Index>& rng, Func& func, const Reducer& reducer ){
+		using Scalar = typename Reducer::value_type;
+		Scalar var;
+		reducer.init(var);
+		if constexpr ( detail::is_range_invocable_redux<Func, Scalar&> ){
+			func( ParallelRange<Target::host>::fromPiece(rng), var );
+		} else {
+			for ( Index i {rng.start()}; i < rng.end(); ++i ){
+				func( static_cast<int>(i), var );
+			}
+		}
+		reducer.reference() = var;
+	}
+
+public:
+	KOKKOS_FUNCTION
+	TeamHandle() = default;
+
+	/* on the host */
+	TeamHandle( const MemberType& member, char* scratch, std::size_t scratchSize ) :
+		m_member {&member},
+		m_scratch {scratch},
+		m_scratchSize {scratchSize}
+	{
+		static_assert(isHost);
+	}
+
+	/* on the device, where the team's scratch memory
+	 * is taken from the Kokkos::TeamPolicy member */
+	KOKKOS_FUNCTION
+	TeamHandle( const MemberType& member, std::size_t scratchSize ) :
+		m_member {&member},
+		m_scratchSize {scratchSize}
+	{
+		static_assert(isDevice);
+		if (scratchSize > 0){
+			this->m_scratch = static_cast<char*>(
+				member.team_scratch(0).get_shmem_aligned(
+					static_cast<std::ptrdiff_t>(scratchSize),
+					static_cast<std::ptrdiff_t>(teamScratch::alignment)
+				)
+			);
+		}
+	}
+
+	KOKKOS_FUNCTION
+	auto member() const -> const MemberType& {
+		return *this->m_member;
+	}
+
+	KOKKOS_FUNCTION
+	Index leagueRank() const {
+		if constexpr (isHost){
+			return this->m_member->leagueRank;
+		} else {
+			return this->m_member->league_rank();
+		}
+	}
+
+	KOKKOS_FUNCTION
+	Index leagueSize() const {
+		if constexpr (isHost){
+			return this->m_member->leagueSize;
+		} else {
+			return this->m_member->league_size();
+		}
+	}
+
+	KOKKOS_FUNCTION
+	int teamRank() const {
+		if constexpr (isHost){
+			return 0;
+		} else {
+			return this->m_member->team_rank();
+		}
+	}
+
+	KOKKOS_FUNCTION
+	int teamSize() const {
+		if constexpr (isHost){
+			return 1;
+		} else {
+			return this->m_member->team_size();
+		}
+	}
+
+	/**
+	 * @brief Waits for all threads of the team,
+	 * e.g. after writing to a scratch buffer, and before reading from it.
+	 */
+	KOKKOS_FUNCTION
+	void barrier() const {
+		if constexpr (isDevice){
+			this->m_member->team_barrier();
+		}
+	}
+
+	/**
+	 * @brief Calls @a func on one thread of the team,
+	 * e.g. to add the team's result in parallel_reduce_team.
+	 */
+	template<typename Func>
+	KOKKOS_FUNCTION
+	void single( Func&& func ) const {
+		if constexpr (isDevice){
+			Kokkos::single( Kokkos::PerTeam(*this->m_member), func );
+		} else {
+			func();
+		}
+	}
+
+	/**
+	 * @brief Returns the next buffer of @a rows x @a cols from
+	 * the team's scratch memory, which is shared by all threads of the team
+	 * on the device, and a slab of a per-thread HostBuffer on the host.
+	 * Its size must be included in TeamConfig::scratchBytes,
+	 * see teamScratchSize. The buffer is not initialised.
+	 */
+	template<typename PlainObjectType>
+	KOKKOS_FUNCTION
+	Eigen::Map<PlainObjectType> scratch( Index rows, Index cols ) const {
+		using Scalar = typename PlainObjectType::Scalar;
+		const std::size_t bytes { teamScratchSize<PlainObjectType>(rows, cols) };
+		assert( this->m_scratchUsed + bytes <= this->m_scratchSize );
+		Scalar* data { reinterpret_cast<Scalar*>(
+			this->m_scratch + this->m_scratchUsed
+		) };
+		this->m_scratchUsed += bytes;
+		return { data, rows, cols };
+	}
+
+	/**
+	 * @brief Same as scratch(rows, cols), for vectors.
+	 */
+	template<typename PlainObjectType>
+	KOKKOS_FUNCTION
+	Eigen::Map<PlainObjectType> scratch( Index size ) const {
+		static_assert( PlainObjectType::IsVectorAtCompileTime );
+		if constexpr ( PlainObjectType::ColsAtCompileTime == 1 ){
+			return this->scratch<PlainObjectType>(size, 1);
+		} else {
+			return this->scratch<PlainObjectType>(1, size);
+		}
+	}
+
+	/**
+	 * @brief Distributes @a pol among the threads of the team.
+	 * @param pol: an integer, or an IndexRange.
+	 */
+	template<typename Policy, typename Func>
+	KOKKOS_FUNCTION
+	void parallel_for( const Policy& pol, Func&& func ) const {
+		const IndexRange<Index> rng {pol};
+		if constexpr (isDevice){
+			Kokkos::parallel_for( Kokkos::TeamThreadRange( *this->m_member,
+					static_cast<int>( rng.start() ), static_cast<int>( rng.end() )
+				),
+				[&](int i){ callIndex(func, i); }
+			);
+		} else {
+			callHost(rng, func);
+		}
+	}
+
+	/**
+	 * @brief Reduces @a pol among the threads of the team,
+	 * and writes the result to @a reducer on every thread of the team.
+	 * @param reducer is created inside the kernel,
+	 * so it must be a Kokkos reducer, e.g. Kokkos::Sum<scalar>(yourResultVar),
+	 * because the factory functions in Kokkidio::redux are host functions.
+	 */
+	template<typename Policy, typename Func, typename Reducer>
+	KOKKOS_FUNCTION
+	void parallel_reduce( const Policy& pol, Func&& func, const Reducer& reducer ) const {
+		using Scalar = typename Reducer::value_type;
+		const IndexRange<Index> rng {pol};
+		if constexpr (isDevice){
+			Kokkos::parallel_reduce( Kokkos::TeamThreadRange( *this->m_member,
+					static_cast<int>( rng.start() ), static_cast<int>( rng.end() )
+				),
+				[&](int i, Scalar& var){ callIndex(func, i, var); },
+				reducer
+			);
+		} else {
+			reduceHost(rng, func, reducer);
+		}
+	}
+
+	/**
+	 * @brief Distributes @a pol among the vector lanes of the calling thread.
+	 */
+	template<typename Policy, typename Func>
+	KOKKOS_FUNCTION
+	void vector_for( const Policy& pol, Func&& func ) const {
+		const IndexRange<Index> rng {pol};
+		if constexpr (isDevice){
+			Kokkos::parallel_for( Kokkos::ThreadVectorRange( *this->m_member,
+					static_cast<int>( rng.start() ), static_cast<int>( rng.end() )
+				),
+				[&](int i){ callIndex(func, i); }
+			);
+		} else {
+			callHost(rng, func);
+		}
+	}
+
+	/**
+	 * @brief Reduces @a pol among the vector lanes of the calling thread.
+	 * @a reducer is a Kokkos reducer, as in parallel_reduce.
+	 */
+	template<typename Policy, typename Func, typename Reducer>
+	KOKKOS_FUNCTION
+	void vector_reduce( const Policy& pol, Func&& func, const Reducer& reducer ) const {
+		using Scalar = typename Reducer::value_type;
+		const IndexRange<Index> rng {pol};
+		if constexpr (isDevice){
+			Kokkos::parallel_reduce( Kokkos::ThreadVectorRange( *this->m_member,
+					static_cast<int>( rng.start() ), static_cast<int>( rng.end() )
+				),
+				[&](int i, Scalar& var){ callIndex(func, i, var); },
+				reducer
+			);
+		} else {
+			reduceHost(rng, func, reducer);
+		}
+	}
+};
+
+
+namespace detail
+{
+
+/* The team scratch memory on the host is a HostBuffer
+ * with one slab per thread, in columns of teamScratch::alignment bytes */
+using TeamScratchCol = Eigen::Array<double, teamScratch::alignment / sizeof(double), 1>;
+using TeamScratchHost = chunk::HostBuffer<TeamScratchCol>;
+
+/* Calls @a func with the TeamHandle of every league rank in @a cfg,
+ * which are distributed among the threads according to @a sched */
+template<typename Func>
+void forEachTeam( const HostSchedule& sched, const TeamConfig& cfg, const Func& func ){
+	if ( cfg.leagueSize <= 0 ){
+		return;
+	}
+	constexpr Index colBytes { static_cast<Index>( sizeof(TeamScratchCol) ) };
+	/* whole cache lines per thread */
+	const Index scratchCols { static_cast<Index>(
+		( cfg.scratchBytes + 63 ) / 64 * 64
+	) / colBytes };
+
+	TeamScratchHost scratch;
+	if (scratchCols > 0){
+		scratch = TeamScratchHost{ scratchCols, scratchCols };
+	}
+	printd( "parallel_team: %i teams, %i bytes of scratch memory per thread.\n"
+		, static_cast<int>(cfg.leagueSize)
+		, static_cast<int>(scratchCols * colBytes)
+	);
+	schedule::forEachPiece( sched,
+		IndexRange<Index>{ 0, cfg.leagueSize },
+		[&](const IndexRange<Index>& piece){
+			char* data {nullptr};
+			if (scratchCols > 0){
+				data = reinterpret_cast<char*>( scratch.get(
+					Chunk<Target::host>{ IndexRange<Index>{0, scratchCols} }
+				).data() );
+			}
+			for ( Index l {piece.start()}; l < piece.end(); ++l ){
+				HostTeamMember member { l, cfg.leagueSize };
+				func( TeamHandle<Target::host>{ member, data, cfg.scratchBytes } );
+			}
+		}
+	);
+}
+
+template<Target target>
+auto teamPolicy( const TeamConfig& cfg ){
+	using Policy = Kokkos::TeamPolicy<ExecutionSpace<target>>;
+	Policy pol { cfg.teamSize > 0 ?
+		Policy( cfg.leagueSize, cfg.teamSize, cfg.vectorLength ) :
+		Policy( cfg.leagueSize, Kokkos::AUTO, cfg.vectorLength )
+	};
+	if ( cfg.scratchBytes > 0 ){
+		/* leaves room for aligning the start of the scratch memory */
+		pol.set_scratch_size( 0, Kokkos::PerTeam( static_cast<std::ptrdiff_t>(
+			cfg.scratchBytes + teamScratch::alignment
+		) ) );
+	}
+	return pol;
+}
+
+} // namespace detail
+
+
+/**
+ * @brief Hierarchical parallel dispatch, similar to Kokkos::parallel_for
+ * with a Kokkos::TeamPolicy. Calls @a func with a TeamHandle<target>
+ * for each of the @a cfg.leagueSize teams,
+ * through which the team's scratch memory and nested ranges are accessed, e.g.
+ * parallel_for_team<target>( {nCols, teamScratchSize<ArrayXs>(nRows)},
+ * 	KOKKOS_LAMBDA(const TeamHandle<target>& team){
+ * 		auto buf { team.template scratch<ArrayXs>(nRows) };
+ * 		team.parallel_for( nRows, [&](int i){ buf[i] = ...; } );
+ * 		team.barrier();
+ * 		...
+ * 	}
+ * );
+ *
+ * On the device, this uses a Kokkos::TeamPolicy,
+ * with @a cfg.scratchBytes of level 0 scratch memory per team.
+ * On the host, the teams are distributed among the threads
+ * according to @a sched (the schedule's chunkSize counts teams),
+ * each thread runs its teams one after another,
+ * and each thread's scratch memory is a slab of a HostBuffer.
+ */
+template<Target target = DefaultTarget, typename Func>
+void parallel_for_team(
+	[[maybe_unused]] const HostSchedule& sched,
+	const TeamConfig& cfg,
+	Func&& func
+){
+	static_assert( std::is_invocable_v<Func, const TeamHandle<target>&> );
+	if constexpr ( target == Target::host ){
+		detail::forEachTeam( sched, cfg, func );
+	} else {
+		static_assert( target == Target::device );
+		const std::size_t scratchSize {cfg.scratchBytes};
+		Kokkos::parallel_for( detail::teamPolicy<target>(cfg),
+			KOKKOS_LAMBDA(const TeamMember<target>& member){
+				func( TeamHandle<target>{member, scratchSize} );
+			}
+		);
+	}
+}
+
+/**
+ * @brief Same as parallel_for_team(sched, cfg, func),
+ * with the default HostSchedule.
+ */
+template<Target target = DefaultTarget, typename Func>
+void parallel_for_team( const TeamConfig& cfg, Func&& func ){
+	parallel_for_team<target>( HostSchedule{}, cfg, std::forward<Func>(func) );
+}
+
+/**
+ * @brief Hierarchical parallel dispatch with reduction,
+ * see parallel_for_team.
+ * @a func takes a TeamHandle<target> and a reference to
+ * @a Reducer::value_type, to which it adds the team's contribution.
+ * On the device, the contributions of all threads are joined,
+ * so a result which every thread of the team has,
+ * e.g. from TeamHandle::parallel_reduce, should be added in TeamHandle::single.
+ *
+ * @param reducer Use the factory functions in Kokkidio::redux,
+ * e.g. redux::sum(yourResultVar).
+ */
+template<Target target = DefaultTarget, typename Func, typename Reducer>
+void parallel_reduce_team(
+	[[maybe_unused]] const HostSchedule& sched,
+	const TeamConfig& cfg,
+	Func&& func,
+	const Reducer& reducer
+){
+	using Scalar = typename Reducer::value_type;
+	static_assert( std::is_invocable_v<Func, const TeamHandle<target>&, Scalar&> );
+	if constexpr ( target == Target::host ){
+		/* one partial result per thread, each on its own cache line */
+		struct alignas(64) Partial {
+			Scalar value;
+		};
+		std::vector<Partial> partials ( detail::host::maxThreads() );
+		for (Partial& partial : partials){
+			reducer.init(partial.value);
+		}
+		detail::forEachTeam( sched, cfg, [&](const TeamHandle<Target::host>& team){
+			func( team, partials[ detail::host::threadNum() ].value );
+		});
+		Scalar var;
+		reducer.init(var);
+		for (const Partial& partial : partials){
+			reducer.join(var, partial.value);
+		}
+		reducer.reference() = var;
+	} else {
+		static_assert( target == Target::device );
+		const std::size_t scratchSize {cfg.scratchBytes};
+		Kokkos::parallel_reduce( detail::teamPolicy<target>(cfg),
+			KOKKOS_LAMBDA(const TeamMember<target>& member, Scalar& var){
+				func( TeamHandle<target>{member, scratchSize}, var );
+			},
+			reducer
+		);
+	}
+}
+
+/**
+ * @brief Same as parallel_reduce_team(sched, cfg, func, reducer),
+ * with the default HostSchedule.
+ */
+template<Target target = DefaultTarget, typename Func, typename Reducer>
+void parallel_reduce_team( const TeamConfig& cfg, Func&& func, const Reducer& reducer ){
+	parallel_reduce_team<target>(
+		HostSchedule{}, cfg, std::forward<Func>(func), reducer
+	);
+}
+
+} // namespace Kokkidio
+
+#endif
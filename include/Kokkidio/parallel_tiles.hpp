@@ -0,0 +1,429 @@
+#ifndef KOKKIDIO_PARALLEL_TILES_HPP
+#define KOKKIDIO_PARALLEL_TILES_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/ViewMap.hpp"
+#include "Kokkidio/DualViewMap.hpp"
+#include "Kokkidio/parallel_for.hpp"
+#include "Kokkidio/parallel_reduce.hpp"
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+
+namespace Kokkidio
+{
+
+/**
+ * @brief Argument of parallel_for_tiles and parallel_reduce_tiles,
+ * which declares how the tiles of @a obj are transferred:
+ * ReadOnly tiles are only copied to the target,
+ * WriteOnly tiles are only copied back to the host,
+ * and ReadWrite tiles are copied both ways.
+ * Eigen objects passed without tiled() are ReadOnly if they are const,
+ * and ReadWrite otherwise.
+ */
+template<typename _EigenType>
+struct TileArg {
+	using EigenType = _EigenType;
+	EigenType& obj;
+	DualViewAccess access;
+};
+
+template<typename EigenType>
+auto tiled( EigenType& obj, DualViewAccess access ) -> TileArg<EigenType> {
+	return {obj, access};
+}
+
+template<typename T>
+struct is_TileArg : std::false_type {};
+
+template<typename EigenType>
+struct is_TileArg<TileArg<EigenType>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_TileArg_v = is_TileArg<T>::value;
+
+/**
+ * @brief Selects whether parallel_for_tiles and parallel_reduce_tiles
+ * stream tiles through separate buffers.
+ * With automatic, that is only done if the target is not the host.
+ * With always, host targets are streamed through host buffers as well,
+ * e.g. to test the streaming in a CPU build.
+ */
+enum class TileStaging {
+	automatic,
+	always,
+};
+
+namespace detail
+{
+
+/* Host object of a tiled dispatch, together with the two target buffers
+ * which its tiles are streamed through, if @a staged is true.
+ * Tiles follow the same rule as Kokkidio::autoRange,
+ * i.e. they consist of rows for column vectors, and of columns otherwise. */
+template<typename _EigenType, Target targetArg, bool _staged>
+class TileStream {
+public:
+	using EigenType = _EigenType;
+	static constexpr Target target { ExecutionTarget<targetArg> };
+	static constexpr bool staged {_staged};
+
+	using PlainObjectType = typename MapTraits<EigenType>::PlainObjectType;
+	using Plain = std::remove_const_t<PlainObjectType>;
+	using Scalar = transcribe_const_t<PlainObjectType, typename Plain::Scalar>;
+	using TileMap = Eigen::Map<PlainObjectType>;
+	using Buffer = ViewMap<Plain, target>;
+
+	static constexpr bool isVector { Plain::ColsAtCompileTime == 1 };
+
+	static_assert( !Plain::IsRowMajor && is_contiguous<EigenType>(),
+		"Tiled dispatch requires contiguous, column-major Eigen objects."
+	);
+	static_assert( ( isVector ?
+			Plain::RowsAtCompileTime :
+			Plain::ColsAtCompileTime
+		) == Eigen::Dynamic,
+		"Tiled dispatch requires a dynamic number of columns (rows, for vectors)."
+	);
+
+protected:
+	using UnmanagedView = Kokkos::View<
+		std::remove_const_t<Scalar>**, Kokkos::LayoutLeft,
+		MemorySpace<target>, Kokkos::MemoryTraits<Kokkos::Unmanaged>
+	>;
+	using UnmanagedView_host = Kokkos::View<
+		Scalar**, Kokkos::LayoutLeft,
+		Kokkos::HostSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>
+	>;
+
+	Scalar* m_data;
+	Index m_rows, m_cols;
+	DualViewAccess m_access;
+	std::array<Buffer, 2> m_buf;
+
+public:
+	TileStream( EigenType& obj, DualViewAccess access ) :
+		m_data {obj.data()},
+		m_rows {obj.rows()},
+		m_cols {obj.cols()},
+		m_access {access}
+	{
+		if constexpr ( std::is_const_v<Scalar> ){
+			assert( !(access & WriteOnly) );
+		}
+	}
+
+	/* Number of items to tile, i.e. rows for vectors, and columns otherwise */
+	Index nItems() const {
+		return isVector ? this->m_rows : this->m_cols;
+	}
+
+	/* Number of scalars per item */
+	Index itemSize() const {
+		return isVector ? 1 : this->m_rows;
+	}
+
+	/* Allocates both buffers with room for @a tileSize items */
+	void reserve( Index tileSize ){
+		if constexpr (staged){
+			for ( Buffer& buf : this->m_buf ){
+				buf = isVector ?
+					Buffer( tileSize, 1 ) :
+					Buffer( this->m_rows, tileSize );
+			}
+		}
+	}
+
+	/* Map to tile [start, start + size) on the target,
+	 * which resides in buffer @a b if the tiles are staged */
+	TileMap tileMap( Index start, Index size, int b ) const {
+		Index rows { isVector ? size : this->m_rows };
+		Index cols { isVector ? 1    : size };
+		if constexpr (staged){
+			return { this->m_buf[b].data(), rows, cols };
+		} else {
+			return { this->m_data + start * this->itemSize(), rows, cols };
+		}
+	}
+
+	template<typename ExecSpace>
+	void copyToTarget( const ExecSpace& space, Index start, Index size, int b ) const {
+		if constexpr (staged){
+			if ( this->m_access & ReadOnly ){
+				Kokkos::deep_copy( space, this->bufView(size, b), this->hostView(start, size) );
+			}
+		}
+	}
+
+	template<typename ExecSpace>
+	void copyToHost( const ExecSpace& space, Index start, Index size, int b ) const {
+		if constexpr ( staged && !std::is_const_v<Scalar> ){
+			if ( this->m_access & WriteOnly ){
+				Kokkos::deep_copy( space, this->hostView(start, size), this->bufView(size, b) );
+			}
+		}
+	}
+
+protected:
+	/* Both sides are contiguous and LayoutLeft,
+	 * so that Kokkos copies them directly, without a temporary */
+	UnmanagedView_host hostView( Index start, Index size ) const {
+		return {
+			this->m_data + start * this->itemSize(),
+			static_cast<std::size_t>( isVector ? size : this->m_rows ),
+			static_cast<std::size_t>( isVector ? 1    : size )
+		};
+	}
+
+	UnmanagedView bufView( Index size, int b ) const {
+		return {
+			this->m_buf[b].data(),
+			static_cast<std::size_t>( isVector ? size : this->m_rows ),
+			static_cast<std::size_t>( isVector ? 1    : size )
+		};
+	}
+};
+
+template<typename T>
+auto toTileArg( T&& arg ){
+	using U = std::remove_reference_t<T>;
+	if constexpr ( is_TileArg_v<std::remove_const_t<U>> ){
+		return std::remove_const_t<U>{arg};
+	} else {
+		return TileArg<U>{ arg, std::is_const_v<U> ? ReadOnly : ReadWrite };
+	}
+}
+
+template<Target target, TileStaging staging>
+inline constexpr bool isStaged {
+	target != Target::host || staging == TileStaging::always
+};
+
+template<Target target, TileStaging staging, typename T>
+auto makeTileStream( T&& arg ){
+	auto tileArg { toTileArg( std::forward<T>(arg) ) };
+	using EigenType = typename decltype(tileArg)::EigenType;
+	return TileStream<EigenType, target, isStaged<target, staging>>{
+		tileArg.obj, tileArg.access
+	};
+}
+
+template<typename... Streams>
+Index tileItems( const std::tuple<Streams...>& streams ){
+	Index nItems { std::get<0>(streams).nItems() };
+	std::apply( [&](const auto&... s){
+		( (void) assert( s.nItems() == nItems ), ... );
+	}, streams );
+	return nItems;
+}
+
+/* The kernel captures the tile maps by value,
+ * so it can be enqueued without waiting for previous tiles */
+template<Target target, typename Policy, typename Func, typename... Maps>
+void dispatchTile( const Policy& pol, const Func& func, Maps... maps ){
+	parallel_for_range<target>( pol, KOKKOS_LAMBDA(ParallelRange<target> rng){
+		func( rng, maps... );
+	});
+}
+
+template<Target target, typename Policy, typename Func, typename Reducer, typename... Maps>
+void dispatchTileReduce(
+	const Policy& pol, const Func& func, const Reducer& reducer, Maps... maps
+){
+	using Scalar = typename Reducer::value_type;
+	parallel_reduce<target>(
+		pol,
+		KOKKOS_LAMBDA(ParallelRange<target> rng, Scalar& result){
+			func( rng, result, maps... );
+		},
+		reducer
+	);
+}
+
+} // namespace detail
+
+/**
+ * @brief Returns the largest tile size (in columns, or rows for vectors)
+ * for which parallel_for_tiles and parallel_reduce_tiles
+ * stay within @a targetBytes of target memory, when called with @a args.
+ * Both tile buffers of each argument are accounted for.
+ */
+template<typename... Args>
+Index tileSizeForBudget( std::size_t targetBytes, Args&&... args ){
+	std::size_t bytesPerItem {0};
+	auto addItem = [&](auto&& arg){
+		auto tileArg { detail::toTileArg(arg) };
+		using P = std::remove_const_t<
+			typename detail::MapTraits<
+				typename decltype(tileArg)::EigenType
+			>::PlainObjectType
+		>;
+		bool isVector { P::ColsAtCompileTime == 1 };
+		bytesPerItem += 2 * sizeof(typename P::Scalar) *
+			static_cast<std::size_t>( isVector ? 1 : tileArg.obj.rows() );
+	};
+	( addItem(args), ... );
+	return std::max<Index>( 1, static_cast<Index>(targetBytes / bytesPerItem) );
+}
+
+/**
+ * @brief Runs @a func over Eigen objects which need not fit into target memory.
+ * The objects in @a args are split into tiles of @a tileSize columns
+ * (or rows, for vectors), which are streamed through two fixed-size
+ * target buffers per object.
+ * Each buffer has its own execution space instance,
+ * on which the copy to the target, the kernel, and the copy back to the host
+ * are enqueued, so that the transfers of one tile overlap
+ * with the computation of the other.
+ * Note that transfers from pageable host memory may limit that overlap.
+ *
+ * @a func is called as func(ParallelRange<target> rng, maps...),
+ * where rng refers to the tile, and each map is an Eigen::Map
+ * of the corresponding tile of args (e.g. Eigen::Map<const ArrayXXs>).
+ * Use rng(map) as usual.
+ *
+ * If the target is the host, then the maps refer to the objects directly,
+ * and no copies are made, unless @a staging is TileStaging::always.
+ *
+ * @param tileSize: use tileSizeForBudget to fit a memory budget.
+ * @param args: Eigen objects, optionally wrapped in tiled(obj, access).
+ * All objects must have the same number of columns (rows, for vectors).
+ */
+template<
+	Target target = DefaultTarget,
+	TileStaging staging = TileStaging::automatic,
+	typename Func, typename... Args
+>
+void parallel_for_tiles( Index tileSize, const Func& func, Args&&... args ){
+	static_assert( sizeof...(Args) > 0 );
+	constexpr Target execTarget { ExecutionTarget<target> };
+
+	auto streams { std::make_tuple(
+		detail::makeTileStream<execTarget, staging>(args)...
+	) };
+	Index nItems { detail::tileItems(streams) };
+	assert( tileSize > 0 );
+	tileSize = std::min( tileSize, nItems );
+
+	if constexpr ( !detail::isStaged<execTarget, staging> ){
+		for ( Index start {0}; start < nItems; start += tileSize ){
+			Index size { std::min( tileSize, nItems - start ) };
+			std::apply( [&](const auto&... s){
+				detail::dispatchTile<execTarget>( size, func, s.tileMap(start, size, 0)... );
+			}, streams );
+		}
+	} else {
+		std::apply( [&](auto&... s){ ( s.reserve(tileSize), ... ); }, streams );
+		auto spaces { Kokkos::Experimental::partition_space(
+			ExecutionSpace<execTarget>{}, 1, 1
+		) };
+		Index tile {0};
+		for ( Index start {0}; start < nItems; start += tileSize, ++tile ){
+			Index size { std::min( tileSize, nItems - start ) };
+			int b { static_cast<int>(tile % 2) };
+			/* Work on one instance is ordered,
+			 * so the previous tile in buffer b has been copied back
+			 * before the next one is copied in */
+			TransferHandle handle { spaces[b] };
+			std::apply( [&](const auto&... s){
+				( s.copyToTarget( spaces[b], start, size, b ), ... );
+				detail::dispatchTile<execTarget>(
+					handle.policy(size), func, s.tileMap(start, size, b)...
+				);
+				( s.copyToHost( spaces[b], start, size, b ), ... );
+			}, streams );
+		}
+		for ( const auto& space : spaces ){
+			space.fence("Kokkidio::parallel_for_tiles");
+		}
+	}
+}
+
+/**
+ * @brief Tiled version of Kokkidio::parallel_reduce,
+ * see parallel_for_tiles.
+ * @a func is called as func(ParallelRange<target> rng, result, maps...).
+ * The reduction of each tile blocks the host,
+ * while the next tile is already being copied to the target.
+ * Tiles are not copied back to the host,
+ * so only ReadOnly arguments are useful here.
+ *
+ * @param reducer: Use the factory functions in Kokkidio::redux,
+ * with the result variable as its argument, e.g. redux::sum(yourResultVar).
+ */
+template<
+	Target target = DefaultTarget,
+	TileStaging staging = TileStaging::automatic,
+	typename Func, typename Reducer, typename... Args
+>
+void parallel_reduce_tiles(
+	Index tileSize, const Func& func, const Reducer& reducer, Args&&... args
+){
+	static_assert( sizeof...(Args) > 0 );
+	constexpr Target execTarget { ExecutionTarget<target> };
+	using Scalar = typename Reducer::value_type;
+
+	auto streams { std::make_tuple(
+		detail::makeTileStream<execTarget, staging>(args)...
+	) };
+	Index nItems { detail::tileItems(streams) };
+	assert( tileSize > 0 );
+	tileSize = std::min( tileSize, nItems );
+
+	Scalar total;
+	reducer.init(total);
+
+	auto reduceTile = [&](const auto& pol, Index start, Index size, int b){
+		Scalar partial;
+		Reducer tileReducer {partial};
+		std::apply( [&](const auto&... s){
+			detail::dispatchTileReduce<execTarget>(
+				pol, func, tileReducer, s.tileMap(start, size, b)...
+			);
+		}, streams );
+		reducer.join(total, partial);
+	};
+
+	if constexpr ( !detail::isStaged<execTarget, staging> ){
+		for ( Index start {0}; start < nItems; start += tileSize ){
+			Index size { std::min( tileSize, nItems - start ) };
+			reduceTile( size, start, size, 0 );
+		}
+	} else {
+		std::apply( [&](auto&... s){ ( s.reserve(tileSize), ... ); }, streams );
+		auto spaces { Kokkos::Experimental::partition_space(
+			ExecutionSpace<execTarget>{}, 1, 1
+		) };
+		auto copyTile = [&](Index start, int b){
+			Index size { std::min( tileSize, nItems - start ) };
+			std::apply( [&](const auto&... s){
+				( s.copyToTarget( spaces[b], start, size, b ), ... );
+			}, streams );
+		};
+		copyTile(0, 0);
+		Index tile {0};
+		for ( Index start {0}; start < nItems; start += tileSize, ++tile ){
+			Index size { std::min( tileSize, nItems - start ) };
+			int b { static_cast<int>(tile % 2) };
+			/* The other buffer was used by the previous tile,
+			 * whose reduction has already finished */
+			if ( start + tileSize < nItems ){
+				copyTile( start + tileSize, 1 - b );
+			}
+			reduceTile( TransferHandle{spaces[b]}.policy(size), start, size, b );
+		}
+		for ( const auto& space : spaces ){
+			space.fence("Kokkidio::parallel_reduce_tiles");
+		}
+	}
+	reducer.reference() = total;
+}
+
+} // namespace Kokkidio
+
+#endif
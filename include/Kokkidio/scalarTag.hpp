@@ -0,0 +1,57 @@
+#ifndef KOKKIDIO_SCALARTAG_HPP
+#define KOKKIDIO_SCALARTAG_HPP
+
+#ifndef KOKKIDIO_PUBLIC_HEADER
+#error "Do not include this file directly. Include Kokkidio/Kokkidio.hpp instead."
+#endif
+
+#include "Kokkidio/typeHelpers.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Kokkidio::detail
+{
+
+/* Identifies the scalar type of the data in binary files,
+ * i.e. MappedFile and checkpoints */
+enum class ScalarTag : std::uint32_t {
+	unknown = 0,
+	float32 = 1,
+	float64 = 2,
+	int32   = 3,
+	int64   = 4,
+};
+
+template<typename Scalar>
+constexpr ScalarTag scalarTag(){
+	using S = std::remove_const_t<Scalar>;
+	if constexpr ( std::is_same_v<S, float> ){
+		return ScalarTag::float32;
+	} else if constexpr ( std::is_same_v<S, double> ){
+		return ScalarTag::float64;
+	} else if constexpr ( std::is_same_v<S, std::int32_t> ){
+		return ScalarTag::int32;
+	} else if constexpr ( std::is_same_v<S, std::int64_t> ){
+		return ScalarTag::int64;
+	} else {
+		static_assert( dependent_false<S>::value,
+			"Scalar type not supported in binary files."
+		);
+		return ScalarTag::unknown;
+	}
+}
+
+constexpr std::size_t scalarSize( ScalarTag tag ){
+	switch (tag){
+		case ScalarTag::float32: return 4;
+		case ScalarTag::float64: return 8;
+		case ScalarTag::int32:   return 4;
+		case ScalarTag::int64:   return 8;
+		default: return 0;
+	}
+}
+
+} // namespace Kokkidio::detail
+
+#endif
@@ -0,0 +1,28 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_CHECKPOINT_ARGS \
+	const ArrayXXs& a, Index nRuns
+
+namespace unif
+{
+
+enum class Kernel {
+	viewmap,
+	dualviewmap_host,
+	dualviewmap_target,
+	mixed_precision,
+	layout_soa,
+	layout_padded,
+};
+
+/* Returns the largest difference between the data which was written
+ * and the data which was read back, or NaN, if reading failed */
+template<Target, Kernel>
+scalar checkpoint(KOKKIDIO_CHECKPOINT_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
@@ -0,0 +1,87 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "checkpoint.hpp"
+
+#include "testMacros.hpp"
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(checkpoint_unif, unif::checkpoint)
+
+void run_checkpoint(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running checkpoint benchmark...\n";
+	}
+
+	ArrayXXs a { ArrayXXs::Random(b.nRows, b.nCols) };
+
+	/* The data is written and read back unchanged,
+	 * and with mixed precision, the conversion is exact
+	 * up to the precision of scalar */
+	auto pass = [&](scalar error){
+		bool same { error <= epsilon };
+		if ( !same ){
+			std::cerr << "Largest difference after reading: " << error << '\n';
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.groupComment = "unified";
+	opts.skipWarmup = b.skipWarmup;
+
+	using T = Target;
+	using uK = unif::Kernel;
+	#ifndef KOKKIDIO_CPU_ONLY
+	if ( b.target != "cpu" ){
+		runAndTime<checkpoint_unif, T::device, uK
+			, uK::viewmap // first one is for warmup
+			, uK::viewmap
+			, uK::dualviewmap_host
+			, uK::dualviewmap_target
+			, uK::mixed_precision
+			, uK::layout_soa
+			, uK::layout_padded
+		>( opts, pass, a, b.nRuns );
+	}
+	#endif
+
+	if ( b.target != "gpu" ){
+		runAndTime<checkpoint_unif, T::host, uK
+			, uK::viewmap // first one is for warmup
+			, uK::viewmap
+			, uK::dualviewmap_host
+			, uK::dualviewmap_target
+			, uK::mixed_precision
+			, uK::layout_soa
+			, uK::layout_padded
+		>( opts, pass, a, b.nRuns );
+	}
+
+	if (!b.gnuplot){
+		std::cout << "checkpoint: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_checkpoint(b);
+
+	return 0;
+}
@@ -49,6 +49,8 @@ enum class Kernel {
 	cstyle,
 	cstyle_nobuf,
 	kokkidio_index,
+	kokkidio_index_unchecked,
+	kokkidio_index_captured,
 	kokkidio_index_merged,
 	kokkidio_range,
 	kokkidio_range_chunks,
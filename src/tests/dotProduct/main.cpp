@@ -99,6 +99,10 @@ void runDot(const BenchOpts b){
 				, uK::cstyle_nobuf
 				)
 				, uK::kokkidio_index
+				#ifdef KOKKIDIO_MAP_CHECKS
+				, uK::kokkidio_index_unchecked
+				#endif
+				, uK::kokkidio_index_captured
 				, uK::kokkidio_range
 				KRUN_IF_ALL(
 				, uK::kokkidio_range_chunks
@@ -137,6 +141,10 @@ void runDot(const BenchOpts b){
 				, uK::cstyle_nobuf
 				)
 				, uK::kokkidio_index
+				#ifdef KOKKIDIO_MAP_CHECKS
+				, uK::kokkidio_index_unchecked
+				#endif
+				, uK::kokkidio_index_captured
 				, uK::kokkidio_range
 				KRUN_IF_ALL(
 				, uK::kokkidio_range_chunks
@@ -66,6 +66,7 @@ enum class Kernel {
 	kokkidio_index_fullbuf,
 	kokkidio_range_fullbuf,
 	kokkidio_range_chunkbuf,
+	kokkidio_range_group,
 	context_ranged,
 };
 
@@ -108,6 +108,7 @@ void runFric(const BenchOpts& b){
 				, uK::kokkidio_index_stackbuf
 				, uK::kokkidio_range_fullbuf
 				, uK::kokkidio_range_chunkbuf
+				, uK::kokkidio_range_group
 				KRUN_IF_ALL(
 				, uK::context_ranged
 				)
@@ -142,6 +143,7 @@ void runFric(const BenchOpts& b){
 				, uK::kokkidio_index_stackbuf // painfully slow
 				, uK::kokkidio_range_fullbuf
 				, uK::kokkidio_range_chunkbuf
+				, uK::kokkidio_range_group
 				KRUN_IF_ALL(
 				, uK::context_ranged
 				)
@@ -0,0 +1,37 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_HUGEPAGES_ARGS \
+	Index nRows, Index nCols, Index nRuns
+
+namespace hugepages_ctrl
+{
+
+KOKKIDIO_HOST_DEVICE_VAR(static constexpr scalar factor {0.5});
+
+} // namespace hugepages_ctrl
+
+struct HugePagesResult {
+	/* all values should be the same */
+	scalar min {0}, max {0};
+	/* bytes of the array, and how many of them the kernel reported
+	 * as backed by transparent huge pages */
+	std::size_t bytes {0}, hugeBytes {0};
+};
+
+namespace unif
+{
+
+enum class Kernel {
+	pageable,
+	hugepages,
+};
+
+template<Target, Kernel>
+HugePagesResult hugepages(KOKKIDIO_HUGEPAGES_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
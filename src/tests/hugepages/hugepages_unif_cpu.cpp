@@ -0,0 +1,3 @@
+/* Huge pages only apply to host memory. */
+#define KOKKIDIO_HUGEPAGES_TARGET Target::host
+#include "hugepages_unif.in"
\ No newline at end of file
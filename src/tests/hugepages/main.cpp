@@ -0,0 +1,77 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "hugepages.hpp"
+
+#include "testMacros.hpp"
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(hugepages_unif, unif::hugepages)
+
+void run_hugepages(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running huge page benchmark...\n";
+	}
+
+	scalar out_correct { 1 + b.nRuns * hugepages_ctrl::factor * 2 };
+
+	auto pass = [&](const HugePagesResult& res){
+		bool same {
+			Eigen::internal::isApprox(res.min, out_correct, epsilon) &&
+			Eigen::internal::isApprox(res.max, out_correct, epsilon)
+		};
+		if ( !same ){
+			std::cerr.precision(16);
+			std::cerr
+				<< "out: [" << res.min << ", " << res.max << "]\n"
+				<< "correct: " << out_correct << '\n';
+		} else if ( !b.gnuplot ){
+			std::cout
+				<< "\tHuge-page backed: " << res.hugeBytes / (1 << 20)
+				<< " of " << res.bytes / (1 << 20) << " MiB\n";
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.groupComment = "unified";
+	opts.skipWarmup = b.skipWarmup;
+
+	using T = Target;
+	using uK = unif::Kernel;
+	/* Huge pages only apply to host memory */
+	if ( b.target != "gpu" ){
+		runAndTime<hugepages_unif, T::host, uK
+			, uK::pageable // first one is for warmup
+			, uK::pageable
+			, uK::hugepages
+		>( opts, pass, b.nRows, b.nCols, b.nRuns );
+	}
+
+	if (!b.gnuplot){
+		std::cout << "hugepages: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_hugepages(b);
+
+	return 0;
+}
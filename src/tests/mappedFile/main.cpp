@@ -0,0 +1,80 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "mappedFile.hpp"
+
+#include "testMacros.hpp"
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(mappedFile_unif, unif::mappedFile)
+
+void run_mappedFile(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running mapped file benchmark...\n";
+	}
+
+	ArrayXXs a { ArrayXXs::Random(b.nRows, b.nCols) };
+
+	/* The mapped data must equal the data which was written,
+	 * and mismatching types must be rejected (NaN otherwise) */
+	auto pass = [&](scalar error){
+		bool same { error <= epsilon };
+		if ( !same ){
+			std::cerr << "Largest difference in the mapped data: " << error << '\n';
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.groupComment = "unified";
+	opts.skipWarmup = b.skipWarmup;
+
+	using T = Target;
+	using uK = unif::Kernel;
+	#ifndef KOKKIDIO_CPU_ONLY
+	if ( b.target != "cpu" ){
+		runAndTime<mappedFile_unif, T::device, uK
+			, uK::viewmap_read // first one is for warmup
+			, uK::viewmap_read
+			, uK::dualviewmap_write
+			, uK::mismatch_errors
+		>( opts, pass, a, b.nRuns );
+	}
+	#endif
+
+	if ( b.target != "gpu" ){
+		runAndTime<mappedFile_unif, T::host, uK
+			, uK::viewmap_read // first one is for warmup
+			, uK::viewmap_read
+			, uK::dualviewmap_write
+			, uK::mismatch_errors
+		>( opts, pass, a, b.nRuns );
+	}
+
+	if (!b.gnuplot){
+		std::cout << "mappedFile: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_mappedFile(b);
+
+	return 0;
+}
@@ -0,0 +1,25 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_MAPPEDFILE_ARGS \
+	const ArrayXXs& a, Index nRuns
+
+namespace unif
+{
+
+enum class Kernel {
+	viewmap_read,
+	dualviewmap_write,
+	mismatch_errors,
+};
+
+/* Returns the largest difference between the data which was written
+ * and the data which was mapped, or NaN, if a check failed */
+template<Target, Kernel>
+scalar mappedFile(KOKKIDIO_MAPPEDFILE_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
@@ -78,6 +78,8 @@ void runNorm(const BenchOpts b){
 				, uK::cstyle
 				, uK::kokkidio_index
 				, uK::kokkidio_range
+				, uK::kokkidio_team
+				, uK::kokkidio_team_scratch
 			>( opts, pass, mat, b.nRuns );
 		}
 	}
@@ -104,6 +106,8 @@ void runNorm(const BenchOpts b){
 				, uK::cstyle
 				, uK::kokkidio_index
 				, uK::kokkidio_range
+				, uK::kokkidio_team
+				, uK::kokkidio_team_scratch
 			>( opts, pass, mat, b.nRuns );
 		}
 	}
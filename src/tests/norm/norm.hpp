@@ -42,6 +42,8 @@ enum class Kernel {
 	cstyle,
 	kokkidio_index,
 	kokkidio_range,
+	kokkidio_team,
+	kokkidio_team_scratch,
 };
 
 template<Target target, Kernel k>
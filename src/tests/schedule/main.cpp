@@ -0,0 +1,75 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "schedule.hpp"
+
+#include "testMacros.hpp"
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(schedule_unif, unif::schedule)
+
+void run_schedule(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running host scheduling benchmark...\n";
+	}
+
+	/* column j holds j + 1 in every row */
+	scalar sum_correct {
+		static_cast<scalar>(b.nRows) * b.nCols * (b.nCols + 1) / 2
+	};
+
+	auto pass = [&](scalar sum){
+		bool same { Eigen::internal::isApprox(sum, sum_correct, epsilon) };
+		if ( !same ){
+			std::cerr.precision(16);
+			std::cerr
+				<< "sum: " << sum << '\n'
+				<< "correct: " << sum_correct << '\n';
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.groupComment = "unified";
+	opts.skipWarmup = b.skipWarmup;
+
+	using T = Target;
+	using uK = unif::Kernel;
+	/* HostSchedule only applies to the host */
+	if ( b.target != "gpu" ){
+		runAndTime<schedule_unif, T::host, uK
+			, uK::segmented // first one is for warmup
+			, uK::segmented
+			, uK::dynamic
+			, uK::guided
+			, uK::stealing
+		>( opts, pass, b.nRows, b.nCols, b.nRuns );
+	}
+
+	if (!b.gnuplot){
+		std::cout << "schedule: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_schedule(b);
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_SCHEDULE_ARGS \
+	Index nRows, Index nCols, Index nRuns
+
+namespace unif
+{
+
+enum class Kernel {
+	segmented,
+	dynamic,
+	guided,
+	stealing,
+};
+
+template<Target, Kernel>
+scalar schedule(KOKKIDIO_SCHEDULE_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
@@ -0,0 +1,3 @@
+/* HostSchedule only applies to the host. */
+#define KOKKIDIO_SCHEDULE_TARGET Target::host
+#include "schedule_unif.in"
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "stencil.hpp"
+
+#include "testMacros.hpp"
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(stencil_unif, unif::stencil)
+
+void run_stencil(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running 2D stencil benchmark...\n";
+	}
+
+	/* a non-constant field, so that every wrong or skipped update shows */
+	ArrayXXs field { ArrayXXs::Random(b.nRows, b.nCols) };
+
+	/* serial reference */
+	ArrayXXs correct {field};
+	{
+		ArrayXXs next {field};
+		for (Index iter {0}; iter < b.nRuns; ++iter){
+			for (Index j {1}; j < b.nCols - 1; ++j){
+				for (Index i {1}; i < b.nRows - 1; ++i){
+					next(i, j) = 0.25 * (
+						correct(i - 1, j) + correct(i + 1, j) +
+						correct(i, j - 1) + correct(i, j + 1)
+					);
+				}
+			}
+			std::swap(correct, next);
+		}
+	}
+
+	auto pass = [&](const ArrayXXs& res){
+		bool same { ( res - correct ).abs().maxCoeff() <= epsilon };
+		if ( !same ){
+			std::cerr.precision(16);
+			std::cerr
+				<< "maximum deviation from the serial result: "
+				<< ( res - correct ).abs().maxCoeff() << '\n';
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.groupComment = "unified";
+	opts.skipWarmup = b.skipWarmup;
+
+	using T = Target;
+	using uK = unif::Kernel;
+	#ifndef KOKKIDIO_CPU_ONLY
+	if ( b.target != "cpu" ){
+		runAndTime<stencil_unif, T::device, uK
+			, uK::range // first one is for warmup
+			, uK::range
+			, uK::range2D
+			, uK::range2D_weights
+		>( opts, pass, field, b.nRuns );
+	}
+	#endif
+
+	if ( b.target != "gpu" ){
+		runAndTime<stencil_unif, T::host, uK
+			, uK::range // first one is for warmup
+			, uK::range
+			, uK::range2D
+			, uK::range2D_weights
+		>( opts, pass, field, b.nRuns );
+	}
+
+	if (!b.gnuplot){
+		std::cout << "stencil: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_stencil(b);
+
+	return 0;
+}
@@ -0,0 +1,23 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_STENCIL_ARGS \
+	const ArrayXXs& field, Index nRuns
+
+namespace unif
+{
+
+enum class Kernel {
+	range,
+	range2D,
+	range2D_weights,
+};
+
+template<Target, Kernel>
+ArrayXXs stencil(KOKKIDIO_STENCIL_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
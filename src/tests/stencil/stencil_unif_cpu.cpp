@@ -0,0 +1,3 @@
+/* we want the unified functions to compile on all backends. */
+#define KOKKIDIO_STENCIL_TARGET Target::host
+#include "stencil_unif.in"
\ No newline at end of file
@@ -0,0 +1,2 @@
+/* we want the unified functions to compile on all backends. */
+#include "stencil_unif.in"
\ No newline at end of file
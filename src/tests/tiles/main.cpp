@@ -0,0 +1,86 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "tiles.hpp"
+
+#include "testMacros.hpp"
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(tiles_unif, unif::tiles)
+
+void run_tiles(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running tiled dispatch benchmark...\n";
+	}
+
+	/* positive values, so that the sum is far from zero */
+	ArrayXXs
+		a      { ArrayXXs::Random(b.nRows, b.nCols) + 1 },
+		c_init { ArrayXXs::Random(b.nRows, b.nCols) + 1 };
+
+	/* b = 2a, and c = c_init + a */
+	scalar sum_correct { ( 3 * a + c_init ).sum() };
+
+	auto pass = [&](scalar sum){
+		bool same { Eigen::internal::isApprox(sum, sum_correct, epsilon) };
+		if ( !same ){
+			std::cerr.precision(16);
+			std::cerr
+				<< "sum: " << sum << '\n'
+				<< "correct: " << sum_correct << '\n';
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.groupComment = "unified";
+	opts.skipWarmup = b.skipWarmup;
+
+	using T = Target;
+	using uK = unif::Kernel;
+	#ifndef KOKKIDIO_CPU_ONLY
+	if ( b.target != "cpu" ){
+		runAndTime<tiles_unif, T::device, uK
+			, uK::resident // first one is for warmup
+			, uK::resident
+			, uK::tiled
+		>( opts, pass, a, c_init, b.nRuns );
+	}
+	#endif
+
+	if ( b.target != "gpu" ){
+		runAndTime<tiles_unif, T::host, uK
+			, uK::resident // first one is for warmup
+			, uK::resident
+			, uK::tiled
+			, uK::tiled_staged
+		>( opts, pass, a, c_init, b.nRuns );
+	}
+
+	if (!b.gnuplot){
+		std::cout << "tiles: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_tiles(b);
+
+	return 0;
+}
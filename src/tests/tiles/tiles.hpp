@@ -0,0 +1,23 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_TILES_ARGS \
+	const ArrayXXs& a, const ArrayXXs& c_init, Index nRuns
+
+namespace unif
+{
+
+enum class Kernel {
+	resident,
+	tiled,
+	tiled_staged,
+};
+
+template<Target, Kernel>
+scalar tiles(KOKKIDIO_TILES_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
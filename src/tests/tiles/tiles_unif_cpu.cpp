@@ -0,0 +1,3 @@
+/* we want the unified functions to compile on all backends. */
+#define KOKKIDIO_TILES_TARGET Target::host
+#include "tiles_unif.in"
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "runAndTime.hpp"
+#include "parseOpts.hpp"
+
+#include "transfer.hpp"
+
+#include "testMacros.hpp"
+
+#include <cstring>
+#include <string>
+
+namespace Kokkidio
+{
+
+KOKKIDIO_FUNC_WRAPPER(transfer_unif, unif::transfer)
+
+void run_transfer(const BenchOpts b){
+	if ( !b.gnuplot ){
+		std::cout << "Running transfer bandwidth benchmark...\n";
+	}
+
+	Index nElems { std::max(b.nRows, b.nCols) };
+	ArrayXs data, data_correct;
+
+	/* data sets of decreasing compressibility */
+	auto setZero = [&](Index n){ data.setZero(n); };
+	auto setMask = [&](Index n){
+		/* roughly 1% ones */
+		data = ( ArrayXs::Random(n) > static_cast<scalar>(0.98) )
+			.template cast<scalar>();
+	};
+	auto setSmooth = [&](Index n){
+		data = ArrayXs::LinSpaced(n, 0, 1).sin();
+	};
+	auto setRandom = [&](Index n){ data.setRandom(n); };
+
+	/* On the host, the codec round trip also covers a last block
+	 * which is smaller than the others, and data smaller than one block */
+	constexpr Index blockSize { detail::codec::blockSize };
+	const Index sizes_host[] { nElems, 3 * blockSize + 7, blockSize - 1 };
+
+	auto pass = [&](double gbps){
+		/* the transfers must be lossless */
+		bool same { std::memcmp(
+			data.data(), data_correct.data(), data.size() * sizeof(scalar)
+		) == 0 };
+		if ( !same ){
+			std::cerr << "Data was changed by the transfers.\n";
+		} else if ( !b.gnuplot ){
+			std::cout << "\tEffective bandwidth: " << gbps << " GB/s\n";
+		}
+		return same;
+	};
+
+	RunOpts opts;
+	opts.useGnuplot = b.gnuplot;
+	opts.impl = b.impl;
+	opts.skipWarmup = b.skipWarmup;
+
+	auto run = [&](const char* entropy, auto&& setData){
+		using T = Target;
+		using uK = unif::Kernel;
+
+		/* Transfers only happen with a GPU */
+		#ifndef KOKKIDIO_CPU_ONLY
+		if ( b.target != "cpu" ){
+			setData(nElems);
+			data_correct = data;
+			opts.groupComment = entropy;
+			runAndTime<transfer_unif, T::device, uK
+				, uK::deep_copy // first one is for warmup
+				, uK::deep_copy
+				, uK::codec_rle
+				, uK::codec_delta
+			>( opts, pass, data, b.nRuns );
+		}
+		#endif
+
+		if ( b.target != "gpu" ){
+			for ( Index n : sizes_host ){
+				setData(n);
+				data_correct = data;
+				opts.groupComment = std::string{entropy} + "-n" + std::to_string(n);
+				runAndTime<transfer_unif, T::host, uK
+					, uK::codec_rle // first one is for warmup
+					, uK::codec_rle
+					, uK::codec_delta
+				>( opts, pass, data, b.nRuns );
+			}
+		}
+	};
+
+	run("zero"  , setZero  );
+	run("mask"  , setMask  );
+	run("smooth", setSmooth);
+	run("random", setRandom);
+
+	if (!b.gnuplot){
+		std::cout << "transfer: Finished runs.\n\n";
+	}
+}
+
+} // namespace Kokkidio
+
+int main(int argc, char** argv){
+
+	Kokkos::ScopeGuard guard(argc, argv);
+
+	namespace K = Kokkidio;
+	K::BenchOpts b;
+	if ( auto exitCode = parseOpts(b, argc, argv) ){
+		exit( exitCode.value() );
+	}
+	if ( !K::checkImpl<K::unif::Kernel>(b) ){
+		return 1;
+	}
+	K::run_transfer(b);
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+#include <Kokkidio.hpp>
+
+namespace Kokkidio
+{
+
+#define KOKKIDIO_TRANSFER_ARGS \
+	ArrayXs& data, Index nRuns
+
+namespace unif
+{
+
+enum class Kernel {
+	deep_copy,
+	codec_rle,
+	codec_delta,
+};
+
+/* Returns the effective bandwidth in GB/s */
+template<Target, Kernel>
+double transfer(KOKKIDIO_TRANSFER_ARGS);
+
+} // namespace unif
+
+} // namespace Kokkidio
@@ -0,0 +1,3 @@
+/* we want the unified functions to compile on all backends. */
+#define KOKKIDIO_TRANSFER_TARGET Target::host
+#include "transfer_unif.in"
\ No newline at end of file